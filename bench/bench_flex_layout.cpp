@@ -0,0 +1,118 @@
+// bench_flex_layout.cpp - GuiPanel FLEX layout against HORIZONTAL/VERTICAL
+//
+// Headless (no window, GL calls never reached): a panel of fixed-size dummy
+// children is laid out with HORIZONTAL/VERTICAL, then with FLEX ROW/COLUMN
+// (justify START, align START), which must give the same positions, then with
+// FLEX wrap + STRETCH + SPACE_BETWEEN. Each run forces a re-arrange per
+// update() and prints the mean time per layout pass.
+//
+//   mge_bench_flex_layout [passes]
+
+#include "GuiPanel.h"
+#include "GuiFrameContext.h"
+#include "GuiInput.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Child with a fixed preferred size that draws nothing
+class Box : public GuiElement {
+public:
+    Box(float w, float h) : m_w(w), m_h(h) { set_alignment(GuiAlignment::TopLeft); }
+    void draw() const override {}
+    std::pair<float,float> preferred_size() const override { return {m_w, m_h}; }
+
+private:
+    float m_w, m_h;
+};
+
+using Boxes = std::vector<std::unique_ptr<Box>>;
+
+std::vector<float> positions(const Boxes& boxes)
+{
+    std::vector<float> xy;
+    xy.reserve(boxes.size() * 2);
+    for (const auto& b : boxes) {
+        const auto size = b->preferred_size();
+        float x = 0.0f, y = 0.0f;
+        b->compute_aligned_xy(size.first, size.second, x, y);
+        xy.push_back(x);
+        xy.push_back(y);
+    }
+    return xy;
+}
+
+// Mean microseconds per forced re-arrange
+double time_layout(GuiPanel& panel, GuiInputState& input, int passes)
+{
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < passes; ++i) {
+        panel.mark_layout_dirty();
+        panel.update(0.0f, input);
+    }
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / passes;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const int passes = argc > 1 ? std::max(1, std::atoi(argv[1])) : 200;
+    GuiFrameContext::set_current(GuiFrameContext::make(1280, 720, 1.0f, 1.0f, 0.0, 0.016f, false));
+    GuiInputState input;
+    std::mt19937 rng(3);
+    bool ok = true;
+
+    for (int count : {1000, 10000}) {
+        // Declared before the panel: the panel goes first and detaches them
+        Boxes boxes;
+        // Large enough that nothing is clipped and one FLEX line holds every child
+        GuiPanel panel;
+        panel.set_size(400000.0f, 400000.0f);
+        panel.setPadding(0.0f);
+        panel.setSpacing(3.0f);
+        for (int i = 0; i < count; ++i) {
+            boxes.emplace_back(new Box(static_cast<float>(5 + rng() % 20), static_cast<float>(5 + rng() % 20)));
+            panel.addChild(boxes.back().get());
+        }
+
+        for (bool row : {true, false}) {
+            panel.setLayout(row ? GuiPanel::LayoutType::HORIZONTAL : GuiPanel::LayoutType::VERTICAL);
+            panel.setFlexWrap(false);
+            panel.setJustifyContent(GuiPanel::FlexJustify::START);
+            panel.update(0.0f, input);
+            const std::vector<float> expected = positions(boxes);
+            const double t_fixed = time_layout(panel, input, passes);
+
+            panel.setLayout(GuiPanel::LayoutType::FLEX);
+            panel.setFlexDirection(row ? GuiPanel::FlexDirection::ROW : GuiPanel::FlexDirection::COLUMN);
+            panel.setAlignItems(GuiPanel::FlexAlign::START);
+            panel.update(0.0f, input);
+            const std::vector<float> got = positions(boxes);
+            int mismatches = 0;
+            for (std::size_t i = 0; i < got.size(); ++i) {
+                if (std::fabs(got[i] - expected[i]) > 1e-2f) ++mismatches;
+            }
+            const double t_flex = time_layout(panel, input, passes);
+
+            panel.setFlexWrap(true);
+            panel.setAlignItems(GuiPanel::FlexAlign::STRETCH);
+            panel.setJustifyContent(GuiPanel::FlexJustify::SPACE_BETWEEN);
+            const double t_wrap = time_layout(panel, input, passes);
+
+            std::printf("%5d %-6s  %-10s %7.1f us   FLEX %7.1f us   FLEX wrap+stretch %7.1f us%s\n",
+                        count, row ? "row" : "column", row ? "HORIZONTAL" : "VERTICAL",
+                        t_fixed, t_flex, t_wrap, mismatches ? "   POSITIONS DIFFER" : "");
+            if (mismatches) ok = false;
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,195 @@
+// bench_text_metrics.cpp - GuiTextMetrics::measure against the former glyph lookup
+//
+// Headless (no window, no GL). First replays random inserts/erases on a
+// GuiTextMetrics and a std::unordered_map and compares them. Then measures
+// random Latin and Cyrillic strings with the unordered_map path GuiText used
+// before GuiTextMetrics (decode one codepoint, hash lookup, accumulate) and
+// with GuiTextMetrics::measure, checks both give the same extents, and
+// prints the best time per string.
+//
+//   mge_bench_text_metrics [trials]
+
+#include "GuiTextMetrics.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using GlyphMap = std::unordered_map<unsigned long, GuiGlyph>;
+
+// UTF-8 decoder of the former GuiText path
+bool decode_utf8(const std::string& s, size_t& i, unsigned long& cp)
+{
+    const unsigned char c0 = static_cast<unsigned char>(s[i++]);
+    if (c0 < 0x80) { cp = c0; return true; }
+    int extra = 0;
+    if ((c0 & 0xE0) == 0xC0) { cp = c0 & 0x1F; extra = 1; }
+    else if ((c0 & 0xF0) == 0xE0) { cp = c0 & 0x0F; extra = 2; }
+    else if ((c0 & 0xF8) == 0xF0) { cp = c0 & 0x07; extra = 3; }
+    else return false;
+    for (int k = 0; k < extra; ++k) {
+        if (i >= s.size()) return false;
+        const unsigned char c = static_cast<unsigned char>(s[i]);
+        if ((c & 0xC0) != 0x80) return false;
+        cp = (cp << 6) | (c & 0x3F);
+        ++i;
+    }
+    return true;
+}
+
+void encode_utf8(std::string& s, unsigned long cp)
+{
+    if (cp < 0x80) {
+        s += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        s += static_cast<char>(0xC0 | (cp >> 6));
+        s += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        s += static_cast<char>(0xE0 | (cp >> 12));
+        s += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        s += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+GuiTextExtents measure_map(const GlyphMap& glyphs, const std::string& s)
+{
+    GuiTextExtents e;
+    for (size_t i = 0; i < s.size();) {
+        unsigned long cp = 0;
+        if (!decode_utf8(s, i, cp)) continue;
+        auto it = glyphs.find(cp);
+        if (it == glyphs.end()) { ++e.missing; continue; }
+        const GuiGlyph& g = it->second;
+        e.ascent = std::max(e.ascent, static_cast<float>(g.bearing_y - g.pad));
+        e.descent = std::max(e.descent, static_cast<float>(g.height - g.bearing_y - g.pad));
+        e.width += static_cast<float>(g.advance >> 6);
+    }
+    return e;
+}
+
+// Dense and sparse codepoints, ~1/3 erases
+bool check_table(std::mt19937& rng)
+{
+    GuiTextMetrics table;
+    GlyphMap ref;
+    for (int i = 0; i < 200000; ++i) {
+        const unsigned long cp = rng() % 3 == 0 ? rng() % 0x300 : 0x400 + rng() % 3000;
+        if (rng() % 3 == 0) {
+            if (table.erase(cp) != (ref.erase(cp) != 0)) {
+                std::fprintf(stderr, "table: erase(U+%04lX) differs\n", cp);
+                return false;
+            }
+        } else {
+            GuiGlyph g;
+            g.advance = rng() % 4000;
+            table.insert(cp, g);
+            ref[cp] = g;
+        }
+    }
+    for (const auto& kv : ref) {
+        const GuiGlyph* g = table.find(kv.first);
+        if (!g || g->advance != kv.second.advance) {
+            std::fprintf(stderr, "table: find(U+%04lX) differs\n", kv.first);
+            return false;
+        }
+    }
+    if (table.size() != ref.size()) {
+        std::fprintf(stderr, "table: %zu glyphs, expected %zu\n", table.size(), ref.size());
+        return false;
+    }
+    std::printf("table     200000 inserts/erases match std::unordered_map (%zu glyphs)\n", ref.size());
+    return true;
+}
+
+volatile float g_sink = 0.0f; // keeps the timed loops from being optimized out
+
+double ms_since(std::chrono::steady_clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// Returns false if the two paths disagree
+bool run(const char* name, bool cyrillic, int length, int trials, std::mt19937& rng)
+{
+    // Same glyph set in both tables: printable Latin-1 and basic Cyrillic
+    GuiTextMetrics metrics;
+    GlyphMap map;
+    auto add = [&](unsigned long cp) {
+        GuiGlyph g;
+        g.advance = 600 + cp % 900;
+        g.bearing_y = 10 + static_cast<int>(cp % 12);
+        g.height = 14 + static_cast<int>(cp % 9);
+        metrics.insert(cp, g);
+        map[cp] = g;
+    };
+    for (unsigned long c = 32; c < 256; ++c) add(c);
+    for (unsigned long c = 0x410; c < 0x450; ++c) add(c);
+
+    // Latin strings are ASCII with ~5% accented letters
+    std::vector<std::string> strings(4096);
+    size_t bytes = 0;
+    for (std::string& s : strings) {
+        for (int k = 0; k < length; ++k) {
+            unsigned long cp = cyrillic ? 0x410 + rng() % 64 : 32 + rng() % 95;
+            if (!cyrillic && rng() % 20 == 0) cp = 0xC0 + rng() % 64;
+            encode_utf8(s, cp);
+        }
+        bytes += s.size();
+    }
+
+    for (const std::string& s : strings) {
+        const GuiTextExtents a = measure_map(map, s);
+        const GuiTextExtents b = metrics.measure(s);
+        if (a.width != b.width || a.ascent != b.ascent || a.descent != b.descent) {
+            std::fprintf(stderr, "%s: extents differ for a %zu-byte string\n", name, s.size());
+            return false;
+        }
+    }
+
+    const int repeats = 50;
+    double best_map = 1e30, best_metrics = 1e30;
+    float sink = 0.0f;
+    for (int t = 0; t < trials; ++t) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeats; ++r)
+            for (const std::string& s : strings) { GuiTextExtents e = measure_map(map, s); sink += e.width + e.ascent; }
+        best_map = std::min(best_map, ms_since(t0));
+
+        t0 = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeats; ++r)
+            for (const std::string& s : strings) { GuiTextExtents e = metrics.measure(s); sink += e.width + e.ascent; }
+        best_metrics = std::min(best_metrics, ms_since(t0));
+    }
+
+    const double per = 1e6 / (static_cast<double>(repeats) * strings.size()); // ms -> ns per string
+    std::printf("%-9s %4d chars %4zu bytes   unordered_map %7.1f ns   GuiTextMetrics %7.1f ns   %.2fx\n",
+                name, length, bytes / strings.size(), best_map * per, best_metrics * per,
+                best_map / best_metrics);
+    g_sink = sink;
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const int trials = argc > 1 ? std::max(1, std::atoi(argv[1])) : 15;
+    std::mt19937 rng(1);
+
+    if (!check_table(rng)) return 1;
+
+    // Label-sized, line-sized and paragraph-sized strings
+    bool ok = true;
+    for (int length : {8, 18, 134}) {
+        ok = run("latin", false, length, trials, rng) && ok;
+        ok = run("cyrillic", true, length, trials, rng) && ok;
+    }
+    return ok ? 0 : 1;
+}
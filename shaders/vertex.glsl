@@ -2,11 +2,17 @@
 
 layout(location = 0) in vec3 aPos;
 
-// Matrice de projection mise à jour côté CPU en fonction de la taille de la fenêtre
-uniform mat4 uProjection;
+// Données de frame partagées avec la GUI (voir src/gui/GuiFrameUniforms.h),
+// envoyées une seule fois par frame
+layout(std140) uniform FrameData {
+    mat4 uOrtho;
+    mat4 uPerspective;
+    vec4 uViewport;
+    vec4 uTime;
+};
 
 void main()
 {
-    gl_Position = uProjection * vec4(aPos, 1.0);
+    gl_Position = uPerspective * vec4(aPos, 1.0);
 }
 
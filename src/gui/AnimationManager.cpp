@@ -2,6 +2,7 @@
 
 #include "AnimationManager.h"
 #include "GuiElement.h"
+#include "GuiFrameContext.h"
 
 AnimationManager& AnimationManager::instance() {
     static AnimationManager inst;
@@ -16,6 +17,10 @@ void AnimationManager::update(float dt) {
     }
 }
 
+void AnimationManager::update(const GuiFrameContext& ctx) {
+    update(ctx.dt);
+}
+
 void AnimationManager::track(GuiElement* e) {
     if (!e) return;
     m_tracked.insert(e);
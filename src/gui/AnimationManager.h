@@ -4,12 +4,14 @@
 #include <unordered_set>
 
 class GuiElement;
+struct GuiFrameContext;
 
 class AnimationManager {
 public:
     static AnimationManager& instance();
 
     void update(float dt);
+    void update(const GuiFrameContext& ctx); // uses ctx.dt
     void track(GuiElement* e);
     void untrack(GuiElement* e);
 
@@ -2,7 +2,7 @@
 
 #include "GuiAnimation.h"
 #include "GuiElement.h"
-#include <glad/glad.h>
+#include "GuiFrameContext.h"
 
 static inline float lerp(float a, float b, float t) { return a + (b - a) * t; }
 
@@ -64,11 +64,10 @@ void ShakeAnimation::on_apply(GuiElement& e, float et) {
 }
 
 void SlideAnimation::on_apply(GuiElement& e, float et) {
-    // Compute framebuffer size
-    GLint vp[4] = {0,0,0,0};
-    glGetIntegerv(GL_VIEWPORT, vp);
-    float fw = static_cast<float>(vp[2]);
-    float fh = static_cast<float>(vp[3]);
+    // Framebuffer size of the current frame
+    const GuiFrameContext& ctx = GuiFrameContext::current();
+    float fw = static_cast<float>(ctx.fb_width);
+    float fh = static_cast<float>(ctx.fb_height);
 
     float start_x = 0.f, start_y = 0.f;
     float end_x = 0.f, end_y = 0.f;
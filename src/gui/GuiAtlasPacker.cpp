@@ -0,0 +1,195 @@
+// GuiAtlasPacker.cpp - Implementation of the shelf packer
+
+#include "GuiAtlasPacker.h"
+
+#include <algorithm>
+#include <cstring>
+
+GuiAtlasPacker::GuiAtlasPacker(int initial_size, int max_size)
+    : m_width(initial_size), m_height(initial_size), m_max_size(std::max(initial_size, max_size))
+{
+    m_pixels.assign(static_cast<std::size_t>(m_width) * static_cast<std::size_t>(m_height), 0);
+}
+
+bool GuiAtlasPacker::place(int w, int h, Rect& out)
+{
+    const int pw = w + kPadding;
+    const int ph = h + kPadding;
+    if (pw > m_width) return false;
+
+    // First shelf tall enough with room left (shelves at most ~1.5x taller than
+    // the glyph, so small glyphs do not waste a tall shelf)
+    for (Shelf& s : m_shelves) {
+        if (ph <= s.height && ph * 3 >= s.height * 2 && s.cursor_x + pw <= m_width) {
+            out = Rect{s.cursor_x, s.y, w, h};
+            s.cursor_x += pw;
+            return true;
+        }
+    }
+    const int next_y = m_shelves.empty() ? 0 : m_shelves.back().y + m_shelves.back().height;
+    if (next_y + ph > m_height) return false;
+    Shelf s;
+    s.y = next_y;
+    s.height = ph;
+    s.cursor_x = pw;
+    m_shelves.push_back(s);
+    out = Rect{0, next_y, w, h};
+    return true;
+}
+
+void GuiAtlasPacker::blit(const Rect& dst, const unsigned char* pixels, int pitch)
+{
+    for (int row = 0; row < dst.h; ++row) {
+        std::memcpy(&m_pixels[static_cast<std::size_t>(dst.y + row) * m_width + dst.x],
+                    pixels + static_cast<std::ptrdiff_t>(row) * pitch,
+                    static_cast<std::size_t>(dst.w));
+    }
+    mark_dirty(dst.y, dst.y + dst.h);
+}
+
+void GuiAtlasPacker::mark_dirty(int y0, int y1)
+{
+    if (m_dirty_y1 <= m_dirty_y0) { m_dirty_y0 = y0; m_dirty_y1 = y1; return; }
+    m_dirty_y0 = std::min(m_dirty_y0, y0);
+    m_dirty_y1 = std::max(m_dirty_y1, y1);
+}
+
+bool GuiAtlasPacker::repack(int new_w, int new_h)
+{
+    // Tallest first: shelves end up filled with glyphs of similar height
+    std::vector<std::pair<std::uint64_t, Rect>> order(m_entries.begin(), m_entries.end());
+    std::sort(order.begin(), order.end(), [](const auto& a, const auto& b) {
+        if (a.second.h != b.second.h) return a.second.h > b.second.h;
+        return a.first < b.first;
+    });
+
+    const int old_w = m_width;
+    const int old_h = m_height;
+    const std::vector<Shelf> old_shelves = m_shelves;
+    m_width = new_w;
+    m_height = new_h;
+    m_shelves.clear();
+    std::vector<Rect> placed(order.size());
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        const Rect& src = order[i].second;
+        if (src.w == 0 || src.h == 0) continue;
+        if (!place(src.w, src.h, placed[i])) {
+            m_width = old_w;
+            m_height = old_h;
+            m_shelves = old_shelves;
+            return false;
+        }
+    }
+
+    if (m_relayout_hook) m_relayout_hook();
+    std::vector<unsigned char> old_pixels(static_cast<std::size_t>(new_w) * static_cast<std::size_t>(new_h), 0);
+    old_pixels.swap(m_pixels);
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        const Rect& src = order[i].second;
+        if (src.w == 0 || src.h == 0) continue;
+        blit(placed[i], &old_pixels[static_cast<std::size_t>(src.y) * old_w + src.x], old_w);
+        m_entries[order[i].first] = placed[i];
+    }
+    mark_dirty(0, m_height);
+    m_generation += 1;
+    return true;
+}
+
+bool GuiAtlasPacker::grow_and_repack(int min_w, int min_h)
+{
+    int new_w = m_width, new_h = m_height;
+    for (;;) {
+        // Double the smaller side first (keeps the atlas close to square)
+        if (new_w <= new_h) new_w *= 2; else new_h *= 2;
+        if (new_w > m_max_size || new_h > m_max_size) return false;
+        if (new_w < min_w + kPadding || new_h < min_h + kPadding) continue;
+        if (repack(new_w, new_h)) return true; // else shelf slack did not fit: next size
+    }
+}
+
+bool GuiAtlasPacker::compact()
+{
+    return repack(m_width, m_height);
+}
+
+bool GuiAtlasPacker::remove(std::uint64_t key)
+{
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) return false;
+    m_used_area -= static_cast<std::size_t>(it->second.w) * static_cast<std::size_t>(it->second.h);
+    m_entries.erase(it);
+    m_generation += 1; // cached lookups may refer to it
+    return true;
+}
+
+bool GuiAtlasPacker::add(std::uint64_t key, const unsigned char* pixels, int w, int h, int pitch)
+{
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) return true;
+    if (w <= 0 || h <= 0 || pixels == nullptr) {
+        m_entries.emplace(key, Rect{});
+        return true;
+    }
+
+    Rect r;
+    while (!place(w, h, r)) {
+        if (!grow_and_repack(w, h)) return false;
+    }
+    blit(r, pixels, pitch);
+    m_entries.emplace(key, r);
+    m_used_area += static_cast<std::size_t>(w) * static_cast<std::size_t>(h);
+    return true;
+}
+
+bool GuiAtlasPacker::restore(int w, int h, const unsigned char* pixels, const std::vector<Shelf>& shelves,
+                            const std::vector<std::pair<std::uint64_t, Rect>>& entries)
+{
+    if (w <= 0 || h <= 0 || w > m_max_size || h > m_max_size || pixels == nullptr) return false;
+    for (const Shelf& s : shelves) {
+        if (s.y < 0 || s.height < 0 || s.y + s.height > h || s.cursor_x < 0 || s.cursor_x > w) return false;
+    }
+    for (const auto& e : entries) {
+        const Rect& r = e.second;
+        if (r.x < 0 || r.y < 0 || r.w < 0 || r.h < 0 || r.x + r.w > w || r.y + r.h > h) return false;
+    }
+
+    if (m_relayout_hook) m_relayout_hook();
+    m_width = w;
+    m_height = h;
+    m_pixels.assign(pixels, pixels + static_cast<std::size_t>(w) * static_cast<std::size_t>(h));
+    m_shelves = shelves;
+    m_entries.clear();
+    m_used_area = 0;
+    for (const auto& e : entries) {
+        m_entries[e.first] = e.second;
+        m_used_area += static_cast<std::size_t>(e.second.w) * static_cast<std::size_t>(e.second.h);
+    }
+    m_dirty_y0 = 0;
+    m_dirty_y1 = h;
+    m_generation += 1;
+    return true;
+}
+
+bool GuiAtlasPacker::find(std::uint64_t key, Rect& out) const
+{
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) return false;
+    out = it->second;
+    return true;
+}
+
+void GuiAtlasPacker::uv_rect(const Rect& r, float& u0, float& v0, float& u1, float& v1) const
+{
+    const float iw = 1.0f / static_cast<float>(m_width);
+    const float ih = 1.0f / static_cast<float>(m_height);
+    u0 = static_cast<float>(r.x) * iw;
+    v0 = static_cast<float>(r.y) * ih;
+    u1 = static_cast<float>(r.x + r.w) * iw;
+    v1 = static_cast<float>(r.y + r.h) * ih;
+}
+
+float GuiAtlasPacker::fill_ratio() const
+{
+    const double area = static_cast<double>(m_width) * static_cast<double>(m_height);
+    return area > 0.0 ? static_cast<float>(static_cast<double>(m_used_area) / area) : 0.0f;
+}
@@ -0,0 +1,101 @@
+// GuiAtlasPacker.h - CPU side of the glyph atlas: shelf packer and pixel copy
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Packs 8-bit coverage bitmaps into one single-channel image (no GL: also
+// used by the offline mge_fontbake tool; GuiGlyphAtlas adds the texture).
+// - Shelf packing: bitmaps are placed left to right on horizontal shelves; a new
+//   shelf opens under the last one when the current shelf is full.
+// - When a bitmap does not fit, the atlas doubles (up to max_size) and repacks
+//   every entry tallest-first, which also reclaims the slack of early shelves.
+//   Entry rects move on repack: generation() is bumped (also on remove) so
+//   callers can refresh cached UVs.
+// - remove() only forgets an entry; compact() repacks the survivors at the
+//   current size to reclaim the holes (used by LRU eviction).
+// - Rows written since clear_dirty() are tracked for partial uploads.
+// - Anything already drawn from the old layout must reach GL before entries
+//   move: the relayout hook (GuiDraw::submit for GuiText) runs first.
+class GuiAtlasPacker {
+public:
+    struct Rect {
+        int x = 0, y = 0;  // top-left in pixels (row 0 = first uploaded row)
+        int w = 0, h = 0;
+    };
+    struct Shelf {
+        int y = 0;
+        int height = 0;
+        int cursor_x = 0;
+    };
+
+    explicit GuiAtlasPacker(int initial_size = 256, int max_size = 4096);
+
+    GuiAtlasPacker(const GuiAtlasPacker&) = delete;
+    GuiAtlasPacker& operator=(const GuiAtlasPacker&) = delete;
+
+    // Copy a w x h bitmap (rows `pitch` bytes apart) under `key`.
+    // Zero-sized bitmaps are recorded with an empty rect. Returns false when the
+    // atlas is full at max_size.
+    bool add(std::uint64_t key, const unsigned char* pixels, int w, int h, int pitch);
+    // Forget an entry; its pixels are reclaimed by the next compact()
+    bool remove(std::uint64_t key);
+    // Repack the remaining entries at the current size (bumps generation())
+    bool compact();
+    // Called before entries move (grow or compact)
+    void set_relayout_hook(void (*hook)()) { m_relayout_hook = hook; }
+    bool find(std::uint64_t key, Rect& out) const;
+    bool contains(std::uint64_t key) const { return m_entries.count(key) != 0; }
+
+    // Normalized UVs of a rect: (u0,v0) top-left, (u1,v1) bottom-right
+    void uv_rect(const Rect& r, float& u0, float& v0, float& u1, float& v1) const;
+
+    // Packed layout, as written by mge_fontbake
+    const unsigned char* pixels() const { return m_pixels.data(); } // width * height
+    const std::vector<Shelf>& shelves() const { return m_shelves; }
+    const std::unordered_map<std::uint64_t, Rect>& entries() const { return m_entries; }
+    // Replace the content with a baked layout (pixels tightly packed, rects and
+    // shelves inside w x h). Later add() calls continue packing after the
+    // baked shelves.
+    bool restore(int w, int h, const unsigned char* pixels, const std::vector<Shelf>& shelves,
+                 const std::vector<std::pair<std::uint64_t, Rect>>& entries);
+
+    // Rows [y0, y1) written since the last clear_dirty() (false when none)
+    bool dirty_rows(int& y0, int& y1) const {
+        y0 = m_dirty_y0; y1 = m_dirty_y1;
+        return m_dirty_y1 > m_dirty_y0;
+    }
+    void clear_dirty() { m_dirty_y0 = 0; m_dirty_y1 = 0; }
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    int max_size() const { return m_max_size; }
+    unsigned int generation() const { return m_generation; }
+    std::size_t entry_count() const { return m_entries.size(); }
+    // Used pixel area (padding excluded) divided by atlas area
+    float fill_ratio() const;
+
+private:
+    bool place(int w, int h, Rect& out);
+    bool grow_and_repack(int min_w, int min_h);
+    bool repack(int new_w, int new_h);
+    void blit(const Rect& dst, const unsigned char* pixels, int pitch);
+    void mark_dirty(int y0, int y1);
+
+    static constexpr int kPadding = 1; // texels between entries (linear filtering)
+
+    int m_width = 0;
+    int m_height = 0;
+    int m_max_size = 0;
+    std::vector<unsigned char> m_pixels;          // m_width * m_height, row-major
+    std::vector<Shelf> m_shelves;
+    std::unordered_map<std::uint64_t, Rect> m_entries;
+    std::size_t m_used_area = 0;
+    unsigned int m_generation = 0;
+    void (*m_relayout_hook)() = nullptr;
+    int m_dirty_y0 = 0;       // rows [y0,y1) changed since clear_dirty()
+    int m_dirty_y1 = 0;
+};
@@ -29,11 +29,6 @@ void GuiCheckbox::set_colors(float box_r, float box_g, float box_b, float box_a,
     m_check_color[0]=check_r; m_check_color[1]=check_g; m_check_color[2]=check_b; m_check_color[3]=check_a;
 }
 
-bool GuiCheckbox::hit_test(float px, float py, float x, float y, float w, float h) const
-{
-    return (px >= x && px <= x + w && py >= y && py <= y + h);
-}
-
 std::pair<float,float> GuiCheckbox::preferred_size() const
 {
     if (m_size_w > 0.0f && m_size_h > 0.0f) return {pixel_w(), pixel_h()};
@@ -44,46 +39,57 @@ std::pair<float,float> GuiCheckbox::preferred_size() const
     return {w, h};
 }
 
-void GuiCheckbox::draw()
+void GuiCheckbox::update(float dt, GuiInputState& input)
 {
     if (!m_visible) return;
     float x = pixel_x();
     float y = pixel_y();
-    float w = pixel_w();
-    float h = pixel_h();
+    float w = box_w();
+    float h = box_h();
     if (w <= 0.0f || h <= 0.0f) {
         auto ps = preferred_size();
         if (w <= 0.0f) w = ps.first;
         if (h <= 0.0f) h = ps.second;
     }
-    if (w <= 0.0f || h <= 0.0f) return;
+    m_rect = DrawRect{x, y, w, h, w > 0.0f && h > 0.0f};
+    if (!m_rect.valid) return;
+    if (culled(x, y, w, h)) { m_rect.valid = false; return; }
 
     // Size of square box
     float box = std::min(h, std::max(18.0f, m_label.preferred_size().second));
     float box_x = x;
     float box_y = y + (h - box) * 0.5f;
+    m_box[0] = box_x; m_box[1] = box_y; m_box[2] = box;
 
-    const auto [mx, my] = GuiInput::mouse_pos_px();
-    const bool hovered = hit_test(static_cast<float>(mx), static_cast<float>(my), box_x, box_y, box, box);
-    if (GuiInput::left_clicked() && hovered) {
+    add_hit_rect(box_x, box_y, box, box);
+    const bool hovered = input.hover == this;
+    if (input.left_clicked && hovered) {
         set_checked(!m_checked);
     }
 
-    // Draw box
-    GuiDraw::draw_rounded_rect(box_x, box_y, box, box, 3.0f, m_box_color);
-    if (m_checked) {
-        float pad = box * 0.2f;
-        GuiDraw::draw_rounded_rect(box_x + pad, box_y + pad, box - 2*pad, box - 2*pad, 2.0f, m_check_color);
-    }
-
     // Label to the right
     auto ts = m_label.preferred_size();
-    if (ts.first > 0.0f) {
+    m_label_shown = ts.first > 0.0f;
+    if (m_label_shown) {
         float asc=0.0f, desc=0.0f;
         bool have = m_label.vertical_extents(asc, desc);
         float base_y = have ? (y + (h - (asc - desc)) * 0.5f + (asc - desc) * 0.6f) : (y + (h - ts.second) * 0.5f + ts.second * 0.6f);
         m_label.set_position(x + box + m_spacing, base_y, false);
-        m_label.draw();
+        m_label.update(dt, input);
+    }
+}
+
+void GuiCheckbox::draw() const
+{
+    if (!m_visible || !m_rect.valid) return;
+
+    // Draw box
+    const float box_x = m_box[0], box_y = m_box[1], box = m_box[2];
+    GuiDraw::draw_rounded_rect(box_x, box_y, box, box, 3.0f, m_box_color);
+    if (m_checked) {
+        float pad = box * 0.2f;
+        GuiDraw::draw_rounded_rect(box_x + pad, box_y + pad, box - 2*pad, box - 2*pad, 2.0f, m_check_color);
     }
+    if (m_label_shown) m_label.draw();
 }
 
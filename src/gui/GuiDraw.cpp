@@ -1,38 +1,69 @@
-// GuiDraw.cpp - Implementation of simple 2D drawing helpers
+// GuiDraw.cpp - Implementation of simple 2D drawing helpers (batched draw list)
 
 #include "GuiDraw.h"
+#include "GuiStreamBuffer.h"
+#include "GuiFrameContext.h"
+#include "GuiGlState.h"
+#include "GuiFrameUniforms.h"
 
 #include <glad/glad.h>
+#include <cmath>
 #include <string>
+#include <vector>
+#include <cstddef>
 
 namespace {
 
-static unsigned int s_rect_vao = 0;
-static unsigned int s_rect_vbo = 0;
-static unsigned int s_rect_shader = 0;
-static int s_rect_uProjLoc = -1;
-static int s_rect_uRectMinLoc = -1;
-static int s_rect_uRectMaxLoc = -1;
-static int s_rect_uRadiusLoc = -1;
-static int s_rect_uColorLoc = -1;
-
-static unsigned int s_tex_vao = 0;
-static unsigned int s_tex_vbo = 0;
-static unsigned int s_tex_shader = 0;
-static int s_tex_uProjLoc = -1;
-static int s_tex_uSamplerLoc = -1;
-
-static void make_ortho(float left, float right, float bottom, float top, float znear, float zfar, float out[16])
-{
-    for (int i=0;i<16;++i) out[i] = 0.0f;
-    out[0] = 2.0f / (right - left);
-    out[5] = 2.0f / (top - bottom);
-    out[10] = -2.0f / (zfar - znear);
-    out[12] = - (right + left) / (right - left);
-    out[13] = - (top + bottom) / (top - bottom);
-    out[14] = - (zfar + znear) / (zfar - znear);
-    out[15] = 1.0f;
-}
+// Primitive kinds understood by the shared shader
+enum Mode : int { MODE_SHAPE = 0, MODE_TEXTURE = 1, MODE_GLYPH = 2, MODE_GLYPH_SDF = 3 };
+
+// One instance of the shared pipeline. The quad corners are generated in the
+// vertex shader from gl_VertexID, so rects, images and glyphs all cost a
+// single instance record and any run of them is one glDrawArraysInstanced.
+struct Instance {
+    float rect[4];       // min.xy, max.xy in pixel space
+    float uv[4];         // u0,v0 (top-left), u1,v1 (bottom-right); unused by shapes
+    float color[4];      // fill / tint
+    float border[4];     // border color (shapes only)
+    float params[4];     // radius, border thickness, mode, unused
+    float xform[4];      // scale.xy, offset.xy applied to rect on the GPU (animations)
+};
+
+// Scissor rect in framebuffer pixels (min.xy, max.xy); `on` false = no clip
+struct Clip {
+    bool on = false;
+    float r[4] = {0, 0, 0, 0};
+    bool operator==(const Clip& o) const {
+        return on == o.on && (!on || (r[0] == o.r[0] && r[1] == o.r[1] && r[2] == o.r[2] && r[3] == o.r[3]));
+    }
+};
+
+// Instances drawn with the same texture and clip in one call. Batches are
+// pooled across frames (their item vectors keep their capacity) and
+// concatenated at flush().
+struct Batch {
+    GLuint texture = 0;          // 0 => shapes only so far, compatible with any texture
+    Clip clip;                   // every item of a batch shares the scissor
+    std::vector<Instance> items;
+    float bounds[4] = {0, 0, 0, 0}; // union of the items' screen rects
+    int first = 0;               // index of items[0] in the uploaded stream
+};
+
+// How many batches back an instance may be moved to find its texture
+constexpr int kBatchLookback = 16;
+
+static unsigned int s_vao = 0;
+static unsigned int s_shader = 0;
+static int s_uTexLoc = -1;
+
+static std::vector<Instance> s_instances; // flush() scratch: batches laid end to end
+static std::vector<Batch> s_batches;      // pool, first s_batch_count are in use
+static std::vector<Clip> s_clips;         // clip stack, back() is current
+static int s_batch_count = 0;
+static bool s_frame_open = false;
+static unsigned long s_frame_index = 0;
+static GuiFrameContext s_frame_ctx{};     // given to begin_frame()
+static GuiDraw::FrameStats s_stats{};
 
 static unsigned int compile_shader(GLenum type, const char* src)
 {
@@ -67,173 +98,415 @@ static unsigned int link_program(GLuint vs, GLuint fs)
     return p;
 }
 
+static bool rects_overlap(const float a[4], const float b[4])
+{
+    return a[0] < b[2] && b[0] < a[2] && a[1] < b[3] && b[1] < a[3];
+}
+
+static void rect_union(float dst[4], const float r[4])
+{
+    if (r[0] < dst[0]) dst[0] = r[0];
+    if (r[1] < dst[1]) dst[1] = r[1];
+    if (r[2] > dst[2]) dst[2] = r[2];
+    if (r[3] > dst[3]) dst[3] = r[3];
+}
+
+// Screen rect of an instance (xform applied, as in the vertex shader)
+static void instance_bounds(const Instance& inst, float out[4])
+{
+    const float ax = inst.rect[0] * inst.xform[0] + inst.xform[2];
+    const float ay = inst.rect[1] * inst.xform[1] + inst.xform[3];
+    const float bx = inst.rect[2] * inst.xform[0] + inst.xform[2];
+    const float by = inst.rect[3] * inst.xform[1] + inst.xform[3];
+    out[0] = ax < bx ? ax : bx; out[2] = ax < bx ? bx : ax;
+    out[1] = ay < by ? ay : by; out[3] = ay < by ? by : ay;
+}
+
+static const Clip& current_clip()
+{
+    static const Clip kNone{};
+    return s_clips.empty() ? kNone : s_clips.back();
+}
+
+// Clip the bounds of a primitive to the current clip; false when nothing of it
+// can show (outside the clip, or outside the viewport within a frame)
+static bool clip_bounds(float bounds[4])
+{
+    const Clip& c = current_clip();
+    if (c.on) {
+        for (int i = 0; i < 2; ++i) {
+            if (bounds[i] < c.r[i]) bounds[i] = c.r[i];
+            if (bounds[i + 2] > c.r[i + 2]) bounds[i + 2] = c.r[i + 2];
+        }
+        if (bounds[2] <= bounds[0] || bounds[3] <= bounds[1]) return false;
+    }
+    if (s_frame_open) {
+        const GuiFrameContext& ctx = s_frame_ctx;
+        if (ctx.fb_width > 0 && ctx.fb_height > 0 &&
+            (bounds[2] <= 0.0f || bounds[3] <= 0.0f ||
+             bounds[0] >= static_cast<float>(ctx.fb_width) || bounds[1] >= static_cast<float>(ctx.fb_height)))
+            return false;
+    }
+    return true;
+}
+
+static int open_batch(GLuint texture)
+{
+    if (s_batch_count == static_cast<int>(s_batches.size())) s_batches.emplace_back();
+    Batch& b = s_batches[static_cast<size_t>(s_batch_count)];
+    b.texture = texture;
+    b.clip = current_clip();
+    b.items.clear();
+    return s_batch_count++;
+}
+
+// Pick the batch that receives a primitive covering `bounds`.
+// Painter's order only matters where things overlap: a textured primitive may
+// join an earlier batch with the same texture as long as nothing recorded after
+// that batch intersects it. This merges the text of every widget (button and
+// checkbox labels, menu items...) into one batch per font atlas even when
+// shapes and other fonts are interleaved. Batches only take primitives of
+// their own clip.
+static int choose_batch(GLuint texture, const float bounds[4])
+{
+    const int n = s_batch_count;
+    if (n == 0) return open_batch(texture);
+    const Clip& clip = current_clip();
+    Batch& last = s_batches[static_cast<size_t>(n - 1)];
+    if (!(last.clip == clip)) return open_batch(texture);
+    if (texture == 0 || last.texture == 0 || last.texture == texture) {
+        if (texture != 0) last.texture = texture; // shapes-only batch adopts the first texture
+        return n - 1;
+    }
+    float above[4] = {last.bounds[0], last.bounds[1], last.bounds[2], last.bounds[3]};
+    for (int k = n - 2; k >= 0 && k >= n - 1 - kBatchLookback; --k) {
+        if (rects_overlap(above, bounds)) break;
+        Batch& b = s_batches[static_cast<size_t>(k)];
+        if ((b.texture == texture || b.texture == 0) && b.clip == clip) {
+            b.texture = texture;
+            s_stats.reordered += 1;
+            return k;
+        }
+        rect_union(above, b.bounds);
+    }
+    return open_batch(texture);
+}
+
+static void append_to_batch(int index, const Instance& inst, const float bounds[4])
+{
+    Batch& b = s_batches[static_cast<size_t>(index)];
+    if (b.items.empty()) { for (int i=0;i<4;++i) b.bounds[i] = bounds[i]; }
+    else rect_union(b.bounds, bounds);
+    b.items.push_back(inst);
+    s_stats.primitives += 1;
+}
+
+static void record_instance(const Instance& inst, GLuint texture)
+{
+    float bounds[4];
+    instance_bounds(inst, bounds);
+    if (!clip_bounds(bounds)) { s_stats.culled += 1; return; }
+    append_to_batch(choose_batch(texture, bounds), inst, bounds);
+}
+
+static void push_instance(const Instance& inst, GLuint texture)
+{
+    record_instance(inst, texture);
+    if (!s_frame_open) GuiDraw::flush();
+}
+
+static Instance make_instance(float x0, float y0, float x1, float y1,
+                              float u0, float v0, float u1, float v1,
+                              const float color[4], const float border[4], float radius, float thickness, int mode)
+{
+    Instance inst{};
+    inst.rect[0] = x0; inst.rect[1] = y0; inst.rect[2] = x1; inst.rect[3] = y1;
+    inst.uv[0] = u0; inst.uv[1] = v0; inst.uv[2] = u1; inst.uv[3] = v1;
+    for (int i=0;i<4;++i) { inst.color[i] = color[i]; inst.border[i] = border ? border[i] : 0.0f; }
+    inst.params[0] = radius;
+    inst.params[1] = thickness;
+    inst.params[2] = static_cast<float>(mode);
+    inst.params[3] = 0.0f;
+    inst.xform[0] = 1.0f; inst.xform[1] = 1.0f;
+    inst.xform[2] = 0.0f; inst.xform[3] = 0.0f;
+    return inst;
+}
+
+// Point the per-instance attributes at the given first instance of the stream
+// uploaded at byte offset `stream_base` of the bound GL_ARRAY_BUFFER
+// (GL 3.3 has no base-instance draw, so each batch re-specifies the offsets).
+static void set_instance_pointers(GLintptr stream_base, int first)
+{
+    const GLsizei stride = sizeof(Instance);
+    const size_t base = static_cast<size_t>(stream_base) + static_cast<size_t>(first) * sizeof(Instance);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, stride, (void*)(base + offsetof(Instance, rect)));
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, (void*)(base + offsetof(Instance, uv)));
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, (void*)(base + offsetof(Instance, color)));
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride, (void*)(base + offsetof(Instance, border)));
+    glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, stride, (void*)(base + offsetof(Instance, params)));
+    glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, stride, (void*)(base + offsetof(Instance, xform)));
+}
+
 } // namespace
 
 namespace GuiDraw {
 
-bool ensure_rect_renderer()
-{
-    if (s_rect_shader && s_rect_vao && s_rect_vbo) return true;
-    if (s_rect_vao == 0) {
-        glGenVertexArrays(1, &s_rect_vao);
-        glBindVertexArray(s_rect_vao);
-        glGenBuffers(1, &s_rect_vbo);
-        glBindBuffer(GL_ARRAY_BUFFER, s_rect_vbo);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 12, nullptr, GL_DYNAMIC_DRAW);
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-        glBindVertexArray(0);
+bool ensure_renderer()
+{
+    if (s_shader && s_vao) return true;
+    if (s_vao == 0) {
+        // Attribute pointers are set per batch into the shared GuiStreamBuffer
+        glGenVertexArrays(1, &s_vao);
+        GuiGlState::bind_vertex_array(s_vao);
+        for (GLuint loc = 0; loc < 6; ++loc) {
+            glEnableVertexAttribArray(loc);
+            glVertexAttribDivisor(loc, 1); // every attribute advances per instance
+        }
     }
-    if (s_rect_shader == 0) {
+    if (s_shader == 0) {
         static const char* VERT = R"GLSL(
             #version 330 core
-            layout(location = 0) in vec2 aPos;
-            uniform mat4 uProjection;
+            layout(location = 0) in vec4 iRect;   // min.xy, max.xy
+            layout(location = 1) in vec4 iUV;     // u0,v0 (top-left), u1,v1 (bottom-right)
+            layout(location = 2) in vec4 iColor;
+            layout(location = 3) in vec4 iBorder;
+            layout(location = 4) in vec4 iParams; // radius, border thickness, mode
+            layout(location = 5) in vec4 iXform;  // scale.xy, offset.xy
+            layout(std140) uniform FrameData {   // see GuiFrameUniforms.h
+                mat4 uOrtho;
+                mat4 uPerspective;
+                vec4 uViewport;
+                vec4 uTime;
+            };
+            out vec2 vUV;
+            flat out vec4 vColor;
+            flat out vec4 vBorder;
+            flat out vec4 vRect;
+            flat out vec4 vParams;
+            const vec2 CORNERS[6] = vec2[6](vec2(0,1), vec2(0,0), vec2(1,0), vec2(0,1), vec2(1,0), vec2(1,1));
             void main() {
-                gl_Position = uProjection * vec4(aPos.xy, 0.0, 1.0);
+                vec2 c = CORNERS[gl_VertexID];
+                vUV = vec2(mix(iUV.x, iUV.z, c.x), mix(iUV.w, iUV.y, c.y));
+                vec4 rect = vec4(iRect.xy * iXform.xy + iXform.zw, iRect.zw * iXform.xy + iXform.zw);
+                vColor = iColor; vBorder = iBorder; vRect = rect; vParams = iParams;
+                gl_Position = uOrtho * vec4(mix(rect.xy, rect.zw, c), 0.0, 1.0);
             }
         )GLSL";
         static const char* FRAG = R"GLSL(
             #version 330 core
+            in vec2 vUV;
+            flat in vec4 vColor;
+            flat in vec4 vBorder;
+            flat in vec4 vRect;
+            flat in vec4 vParams;
             out vec4 FragColor;
-            uniform vec2 uRectMin;
-            uniform vec2 uRectMax;
-            uniform float uRadius;
-            uniform vec4 uColor;
+            uniform sampler2D uTex;
             float sdRoundBox(vec2 p, vec2 b, float r){ vec2 q=abs(p)-(b-vec2(r)); return length(max(q,0.0))-r; }
             void main(){
-                vec2 size = uRectMax - uRectMin;
-                vec2 center = uRectMin + size * 0.5;
+                int mode = int(vParams.z + 0.5);
+                if (mode == 1) { FragColor = texture(uTex, vUV); return; }
+                if (mode == 2) { FragColor = vec4(vColor.rgb, vColor.a * texture(uTex, vUV).r); return; }
+                if (mode == 3) {
+                    // Distance field: 128/255 on the outline; fwidth keeps a ~1px
+                    // anti-aliased edge whatever the scale
+                    float dist = texture(uTex, vUV).r;
+                    float aa = max(fwidth(dist) * 0.5, 1e-4);
+                    float cov = smoothstep(0.5 - aa, 0.5 + aa, dist);
+                    FragColor = vec4(vColor.rgb, vColor.a * cov);
+                    return;
+                }
+                vec2 size = vRect.zw - vRect.xy;
+                vec2 center = vRect.xy + size * 0.5;
                 vec2 p = gl_FragCoord.xy - center;
-                vec2 halfSize = size * 0.5;
-                float d = sdRoundBox(p, halfSize, uRadius);
+                float d = sdRoundBox(p, size * 0.5, vParams.x);
                 if (d > 0.0) discard;
-                FragColor = uColor;
+                // Border band of vParams.y pixels inside the edge, same pass as the fill
+                float inner = d + vParams.y;
+                FragColor = (inner > 0.0 && vBorder.a > 0.0) ? vBorder : vColor;
             }
         )GLSL";
         GLuint vs = compile_shader(GL_VERTEX_SHADER, VERT);
         GLuint fs = compile_shader(GL_FRAGMENT_SHADER, FRAG);
         if (!vs || !fs) return false;
-        s_rect_shader = link_program(vs, fs);
+        s_shader = link_program(vs, fs);
         glDeleteShader(vs);
         glDeleteShader(fs);
-        if (!s_rect_shader) return false;
-        s_rect_uProjLoc = glGetUniformLocation(s_rect_shader, "uProjection");
-        s_rect_uRectMinLoc = glGetUniformLocation(s_rect_shader, "uRectMin");
-        s_rect_uRectMaxLoc = glGetUniformLocation(s_rect_shader, "uRectMax");
-        s_rect_uRadiusLoc = glGetUniformLocation(s_rect_shader, "uRadius");
-        s_rect_uColorLoc = glGetUniformLocation(s_rect_shader, "uColor");
+        if (!s_shader) return false;
+        GuiFrameUniforms::bind_program(s_shader);
+        s_uTexLoc = glGetUniformLocation(s_shader, "uTex");
+        GuiGlState::use_program(s_shader);
+        if (s_uTexLoc >= 0) glUniform1i(s_uTexLoc, 0);
     }
     return true;
 }
 
-void draw_rounded_rect(float x, float y, float w, float h, float radius, const float color[4])
+void begin_frame(const GuiFrameContext& ctx)
 {
-    if (!ensure_rect_renderer()) return;
-    // Quad verts
-    float verts[12] = {
-        x,     y,
-        x,     y + h,
-        x + w, y + h,
-        x,     y,
-        x + w, y + h,
-        x + w, y
-    };
-
-    // Ortho from current framebuffer size
-    GLint vp[4] = {0,0,0,0};
-    glGetIntegerv(GL_VIEWPORT, vp);
-    float proj[16];
-    make_ortho(0.0f, static_cast<float>(vp[2]), 0.0f, static_cast<float>(vp[3]), -1.0f, 1.0f, proj);
-
-    glUseProgram(s_rect_shader);
-    glUniformMatrix4fv(s_rect_uProjLoc, 1, GL_FALSE, proj);
-    glUniform2f(s_rect_uRectMinLoc, x, y);
-    glUniform2f(s_rect_uRectMaxLoc, x + w, y + h);
-    glUniform1f(s_rect_uRadiusLoc, radius);
-    glUniform4fv(s_rect_uColorLoc, 1, color);
-
-    glBindVertexArray(s_rect_vao);
-    glBindBuffer(GL_ARRAY_BUFFER, s_rect_vbo);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(verts), verts);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
-    glUseProgram(0);
-}
-
-bool ensure_tex_renderer()
-{
-    if (s_tex_shader && s_tex_vao && s_tex_vbo) return true;
-    if (s_tex_vao == 0) {
-        glGenVertexArrays(1, &s_tex_vao);
-        glBindVertexArray(s_tex_vao);
-        glGenBuffers(1, &s_tex_vbo);
-        glBindBuffer(GL_ARRAY_BUFFER, s_tex_vbo);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 24, nullptr, GL_DYNAMIC_DRAW);
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2*sizeof(float)));
-        glBindVertexArray(0);
+    s_frame_ctx = ctx;
+    GuiGlState::begin_frame(); // scene code may have touched GL since last frame
+    s_batch_count = 0;
+    s_clips.clear();
+    s_stats = FrameStats{};
+    s_frame_open = true;
+    s_frame_index += 1;
+    GuiStreamBuffer::instance().begin_frame();
+}
+
+bool frame_open() { return s_frame_open; }
+
+unsigned long frame_index() { return s_frame_index; }
+
+const FrameStats& frame_stats() { return s_stats; }
+
+void push_clip(float x, float y, float w, float h, bool intersect)
+{
+    Clip c;
+    c.on = true;
+    c.r[0] = x; c.r[1] = y; c.r[2] = x + w; c.r[3] = y + h;
+    const Clip& cur = current_clip();
+    if (intersect && cur.on) {
+        for (int i = 0; i < 2; ++i) {
+            if (c.r[i] < cur.r[i]) c.r[i] = cur.r[i];
+            if (c.r[i + 2] > cur.r[i + 2]) c.r[i + 2] = cur.r[i + 2];
+        }
     }
-    if (s_tex_shader == 0) {
-        static const char* VERT = R"GLSL(
-            #version 330 core
-            layout(location = 0) in vec2 aPos;
-            layout(location = 1) in vec2 aUV;
-            out vec2 vUV;
-            uniform mat4 uProjection;
-            void main(){ vUV = aUV; gl_Position = uProjection * vec4(aPos.xy, 0.0, 1.0); }
-        )GLSL";
-        static const char* FRAG = R"GLSL(
-            #version 330 core
-            in vec2 vUV;
-            out vec4 FragColor;
-            uniform sampler2D uTex;
-            void main(){ FragColor = texture(uTex, vUV); }
-        )GLSL";
-        GLuint vs = compile_shader(GL_VERTEX_SHADER, VERT);
-        GLuint fs = compile_shader(GL_FRAGMENT_SHADER, FRAG);
-        if (!vs || !fs) return false;
-        s_tex_shader = link_program(vs, fs);
-        glDeleteShader(vs);
-        glDeleteShader(fs);
-        if (!s_tex_shader) return false;
-        s_tex_uProjLoc = glGetUniformLocation(s_tex_shader, "uProjection");
-        s_tex_uSamplerLoc = glGetUniformLocation(s_tex_shader, "uTex");
+    if (c.r[2] < c.r[0]) c.r[2] = c.r[0]; // empty: everything is culled
+    if (c.r[3] < c.r[1]) c.r[3] = c.r[1];
+    s_clips.push_back(c);
+}
+
+void pop_clip()
+{
+    if (!s_clips.empty()) s_clips.pop_back();
+}
+
+// Submit the recorded batches (shared by flush() and submit())
+static void draw_recorded(bool in_frame)
+{
+    if (s_batch_count == 0) return;
+    const int batch_count = s_batch_count;
+    s_batch_count = 0;
+    if (!in_frame) GuiGlState::invalidate(); // immediate mode: GL state unknown
+    if (!ensure_renderer()) return;
+
+    // Lay the batches end to end and upload the stream once into the shared ring
+    s_instances.clear();
+    for (int i = 0; i < batch_count; ++i) {
+        Batch& b = s_batches[static_cast<size_t>(i)];
+        b.first = static_cast<int>(s_instances.size());
+        s_instances.insert(s_instances.end(), b.items.begin(), b.items.end());
     }
-    return true;
+    if (s_instances.empty()) return;
+    GuiStreamBuffer& ring = GuiStreamBuffer::instance();
+    const GLintptr stream_base = ring.upload(s_instances.data(), s_instances.size() * sizeof(Instance));
+    if (stream_base < 0) return;
+
+    // Projection and scene depth state come from the frame context (no GL query);
+    // the FrameData block is normally uploaded already, update() is then a no-op.
+    GuiFrameUniforms::update(s_frame_ctx);
+
+    GuiGlState::set_blend(true);
+    GuiGlState::blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GuiGlState::set_depth_test(false); // HUD overlay
+
+    GuiGlState::use_program(s_shader);
+    GuiGlState::bind_vertex_array(s_vao);
+    GuiGlState::bind_array_buffer(ring.buffer());
+
+    for (int i = 0; i < batch_count; ++i) {
+        const Batch& b = s_batches[static_cast<size_t>(i)];
+        if (b.items.empty()) continue;
+        GuiGlState::set_scissor_test(b.clip.on);
+        if (b.clip.on) {
+            // Pixel edges covering the clip (GL scissors whole pixels)
+            const GLint x0 = static_cast<GLint>(std::floor(b.clip.r[0]));
+            const GLint y0 = static_cast<GLint>(std::floor(b.clip.r[1]));
+            const GLint x1 = static_cast<GLint>(std::ceil(b.clip.r[2]));
+            const GLint y1 = static_cast<GLint>(std::ceil(b.clip.r[3]));
+            GuiGlState::scissor(x0, y0, x1 - x0, y1 - y0);
+        }
+        if (b.texture != 0) GuiGlState::bind_texture_2d(0, b.texture);
+        set_instance_pointers(stream_base, b.first);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 6, static_cast<GLsizei>(b.items.size()));
+        s_stats.draw_calls += 1;
+    }
+    s_stats.instances += static_cast<int>(s_instances.size());
+
+    // The range just drawn may be overwritten once the GPU is done with it
+    ring.fence();
+
+    // Bindings are left in place (the shadow makes the next flush cheap);
+    // the scissor is turned off and the scene's depth state restored.
+    GuiGlState::set_scissor_test(false);
+    if (s_frame_ctx.scene_depth_test) GuiGlState::set_depth_test(true);
+}
+
+void flush()
+{
+    const bool in_frame = s_frame_open;
+    s_frame_open = false;
+    draw_recorded(in_frame);
+}
+
+void submit()
+{
+    if (s_frame_open) draw_recorded(true);
+}
+
+void draw_rounded_rect(float x, float y, float w, float h, float radius, const float color[4])
+{
+    push_instance(make_instance(x, y, x + w, y + h, 0.0f, 0.0f, 0.0f, 0.0f, color, nullptr, radius, 0.0f, MODE_SHAPE), 0);
+}
+
+void draw_rounded_rect_bordered(float x, float y, float w, float h, float radius,
+                                const float fill[4], const float border[4], float thickness)
+{
+    push_instance(make_instance(x, y, x + w, y + h, 0.0f, 0.0f, 0.0f, 0.0f, fill, border, radius, thickness, MODE_SHAPE), 0);
 }
 
 void draw_textured_quad(float x, float y, float w, float h, GLuint texture)
 {
-    if (!ensure_tex_renderer()) return;
-    float verts[24] = {
-        // x, y, u, v
-        x,     y,     0.0f, 0.0f,
-        x,     y + h, 0.0f, 1.0f,
-        x + w, y + h, 1.0f, 1.0f,
-        x,     y,     0.0f, 0.0f,
-        x + w, y + h, 1.0f, 1.0f,
-        x + w, y,     1.0f, 0.0f,
-    };
-
-    GLint vp[4] = {0,0,0,0};
-    glGetIntegerv(GL_VIEWPORT, vp);
-    float proj[16];
-    make_ortho(0.0f, static_cast<float>(vp[2]), 0.0f, static_cast<float>(vp[3]), -1.0f, 1.0f, proj);
-
-    glUseProgram(s_tex_shader);
-    glUniformMatrix4fv(s_tex_uProjLoc, 1, GL_FALSE, proj);
-    glUniform1i(s_tex_uSamplerLoc, 0);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glBindVertexArray(s_tex_vao);
-    glBindBuffer(GL_ARRAY_BUFFER, s_tex_vbo);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(verts), verts);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
-    glUseProgram(0);
+    static const float WHITE[4] = {1.f, 1.f, 1.f, 1.f};
+    // Images are uploaded bottom row first: v=1 at the top edge
+    push_instance(make_instance(x, y, x + w, y + h, 0.0f, 1.0f, 1.0f, 0.0f, WHITE, nullptr, 0.0f, 0.0f, MODE_TEXTURE), texture);
+}
+
+void draw_glyph_quad(float x0, float y0, float x1, float y1,
+                     float u0, float v0, float u1, float v1,
+                     GLuint texture, const float color[4])
+{
+    push_instance(make_instance(x0, y0, x1, y1, u0, v0, u1, v1, color, nullptr, 0.0f, 0.0f, MODE_GLYPH), texture);
+}
+
+void draw_glyph_run(const GlyphQuad* quads, int count, GLuint texture,
+                    const float color[4], const float xform[4], bool sdf)
+{
+    const int mode = sdf ? MODE_GLYPH_SDF : MODE_GLYPH;
+    if (!quads || count <= 0) return;
+    // The whole run goes to one batch, chosen from its overall bounds
+    float run_bounds[4] = {0, 0, 0, 0};
+    for (int i = 0; i < count; ++i) {
+        const GlyphQuad& q = quads[i];
+        Instance inst = make_instance(q.x0, q.y0, q.x1, q.y1, q.u0, q.v0, q.u1, q.v1,
+                                      color, nullptr, 0.0f, 0.0f, mode);
+        if (xform) { for (int k=0;k<4;++k) inst.xform[k] = xform[k]; }
+        float b[4];
+        instance_bounds(inst, b);
+        if (i == 0) { for (int k=0;k<4;++k) run_bounds[k] = b[k]; }
+        else rect_union(run_bounds, b);
+    }
+    if (!clip_bounds(run_bounds)) { s_stats.culled += 1; return; }
+    const int batch = choose_batch(texture, run_bounds);
+    for (int i = 0; i < count; ++i) {
+        const GlyphQuad& q = quads[i];
+        Instance inst = make_instance(q.x0, q.y0, q.x1, q.y1, q.u0, q.v0, q.u1, q.v1,
+                                      color, nullptr, 0.0f, 0.0f, mode);
+        if (xform) { for (int k=0;k<4;++k) inst.xform[k] = xform[k]; }
+        float b[4];
+        instance_bounds(inst, b);
+        append_to_batch(batch, inst, b);
+    }
+    if (!s_frame_open) flush(); // immediate mode: still one draw for the run
 }
 
 } // namespace GuiDraw
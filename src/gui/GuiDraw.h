@@ -3,20 +3,83 @@
 
 #include <glad/glad.h>
 
+struct GuiFrameContext;
+
 namespace GuiDraw {
 
-// Ensure GL resources for solid rectangle/rounded-rect rendering
-bool ensure_rect_renderer();
+// Per-frame draw list.
+// Between begin_frame() and flush(), every draw_* helper below only records one
+// instance (rect, uv, colors, radius, border) into a single instance stream.
+// flush() then submits the stream with glDrawArraysInstanced, one draw call per
+// texture batch. Textured primitives (glyph runs of every widget, images) join
+// an earlier batch of the same texture when nothing recorded since overlaps
+// them, so painter's order is kept wherever it is visible.
+// Outside of a begin_frame()/flush() pair, each helper flushes immediately.
+// Projection, depth handling and the viewport cull come from the context given
+// to begin_frame() (the application publishes it with set_current() first).
+void begin_frame(const GuiFrameContext& ctx);
+void flush();
+bool frame_open();
+// Draw what has been recorded so far and keep the frame open. Used before a
+// shared texture is rewritten mid-frame (glyph atlas repack).
+void submit();
+// Number of begin_frame() calls so far (frame stamp for caches)
+unsigned long frame_index();
+
+// Counters for the last flushed frame (or accumulated since begin_frame()
+// when helpers are used outside a frame).
+struct FrameStats {
+    int draw_calls = 0;  // glDrawArraysInstanced issued
+    int primitives = 0;  // quads recorded (rects, images, glyphs)
+    int instances = 0;   // instances uploaded
+    int reordered = 0;   // primitives/runs moved into an earlier batch of the same texture
+    int culled = 0;      // primitives/runs dropped: entirely outside the clip or the viewport
+};
+const FrameStats& frame_stats();
+
+// Clip stack. Primitives recorded while a clip is pushed are drawn with the
+// scissor set to it (batches only merge primitives of the same clip); a pushed
+// rect is intersected with the current clip unless `intersect` is false
+// (popups escaping their container). Within a frame, primitives entirely
+// outside the current clip or the viewport are not recorded.
+// begin_frame() empties the stack.
+void push_clip(float x, float y, float w, float h, bool intersect = true);
+void pop_clip();
+
+// Ensure GL resources shared by every primitive of the draw list
+bool ensure_renderer();
+
 // Draw a filled rectangle with optional rounded corners
 void draw_rounded_rect(float x, float y, float w, float h, float radius, const float color[4]);
 inline void draw_rect(float x, float y, float w, float h, const float color[4]) {
     draw_rounded_rect(x, y, w, h, 0.0f, color);
 }
+// Rounded rect with an inner border band of `thickness` pixels, drawn in the same
+// instance as the fill (border skipped when its alpha is 0)
+void draw_rounded_rect_bordered(float x, float y, float w, float h, float radius,
+                                const float fill[4], const float border[4], float thickness);
 
-// Ensure GL resources for textured quad
-bool ensure_tex_renderer();
 // Draw a textured quad (no tint), texture must be GL_TEXTURE_2D
 void draw_textured_quad(float x, float y, float w, float h, GLuint texture);
 
-} // namespace GuiDraw
+// Draw a glyph quad: coverage is read from the RED channel of `texture` and
+// multiplied with `color`. (x0,y0) is the bottom-left corner; (u0,v0) maps to
+// the top-left of the glyph bitmap, as FreeType stores rows top-down.
+void draw_glyph_quad(float x0, float y0, float x1, float y1,
+                     float u0, float v0, float u1, float v1,
+                     GLuint texture, const float color[4]);
 
+// A glyph quad of a pre-laid-out run (same conventions as draw_glyph_quad)
+struct GlyphQuad {
+    float x0, y0, x1, y1;
+    float u0, v0, u1, v1;
+};
+// Draw a whole run sharing one texture and color. `xform` = (scale x, scale y,
+// offset x, offset y) is applied on the GPU as p * scale + offset, so cached runs
+// can be animated without touching their quads (nullptr = identity).
+// With `sdf`, the texture holds signed distances (128 on the outline) instead of
+// coverage, so the run stays sharp at any scale.
+void draw_glyph_run(const GlyphQuad* quads, int count, GLuint texture,
+                    const float color[4], const float xform[4], bool sdf = false);
+
+} // namespace GuiDraw
@@ -3,10 +3,93 @@
 #include "GuiElement.h"
 #include "GuiAnimation.h"
 #include "AnimationManager.h"
+#include "GuiDraw.h"
+#include "GuiHitTest.h"
 
 #include <algorithm>
 
-GuiElement::~GuiElement() = default;
+namespace {
+
+GuiElement::LayoutCounters s_layout_cur;
+GuiElement::LayoutCounters s_layout_last;
+unsigned long s_layout_frame = 0;
+
+// Counters follow GuiDraw frames: the first use in a new frame rolls them
+void roll_layout_counters()
+{
+    const unsigned long frame = GuiDraw::frame_index();
+    if (frame == s_layout_frame) return;
+    s_layout_last = (frame == s_layout_frame + 1) ? s_layout_cur : GuiElement::LayoutCounters{};
+    s_layout_cur = GuiElement::LayoutCounters{};
+    s_layout_frame = frame;
+}
+
+} // namespace
+
+GuiElement::~GuiElement()
+{
+    if (m_layout_parent.ptr) m_layout_parent.ptr->remove_layout_child(this);
+    if (m_hit_frame != 0 && GuiHitTest::instance().frame() <= m_hit_frame) GuiHitTest::instance().forget(this);
+}
+
+void GuiElement::add_hit_rect(float x, float y, float w, float h, bool overlay)
+{
+    GuiHitTest& hits = GuiHitTest::instance();
+    hits.add(this, x, y, w, h, overlay);
+    m_hit_frame = hits.frame() + 1; // routed at the next route(), dropped at the one after
+}
+
+bool GuiElement::culled(float x, float y, float w, float h)
+{
+    int fw = 0, fh = 0;
+    get_framebuffer_size(fw, fh);
+    bool out = fw > 0 && fh > 0 &&
+               (x + w <= 0.0f || y + h <= 0.0f || x >= static_cast<float>(fw) || y >= static_cast<float>(fh));
+    if (!out) out = GuiHitTest::instance().clipped_out(x, y, w, h);
+    if (out) {
+        roll_layout_counters();
+        ++s_layout_cur.culled;
+    }
+    return out;
+}
+
+void GuiElement::mark_layout_dirty()
+{
+    for (GuiElement* e = this; e; e = e->m_layout_parent.ptr) {
+        e->m_measure_dirty = true;
+        e->m_layout_dirty = true;
+    }
+}
+
+std::pair<float,float> GuiElement::measure()
+{
+    // Percentage sizes follow the framebuffer: never cached
+    if (m_measure_dirty || m_size_is_percent) {
+        m_measured = preferred_size();
+        m_measure_dirty = false;
+        roll_layout_counters();
+        ++s_layout_cur.measured;
+    }
+    return m_measured;
+}
+
+void GuiElement::count_arranged(int children)
+{
+    roll_layout_counters();
+    s_layout_cur.arranged += children;
+}
+
+const GuiElement::LayoutCounters& GuiElement::frame_layout_counters()
+{
+    roll_layout_counters();
+    return s_layout_last;
+}
+
+const GuiElement::LayoutCounters& GuiElement::current_layout_counters()
+{
+    roll_layout_counters();
+    return s_layout_cur;
+}
 
 // Define deleter after Animation is complete
 void AnimDeleter::operator()(Animation* p) const { delete p; }
@@ -5,7 +5,9 @@
 #include <vector>
 #include <memory>
 #include <glad/glad.h>
+#include "GuiFrameContext.h"
 
+struct GuiInputState;
 // Forward declaration of animation base (defined in GuiAnimation.h)
 class Animation;
 struct AnimDeleter { void operator()(Animation*) const; };
@@ -42,14 +44,15 @@ public:
     }
     void set_size(float w, float h, bool in_percentage = false) {
         m_size_w = w; m_size_h = h; m_size_is_percent = in_percentage;
+        mark_layout_dirty();
     }
 
     // Alignment configuration. When set, the element's position is computed
     // relative to its parent rectangle (or the framebuffer if none) according
     // to the selected anchor and the optional anchor offset (margin).
-    void set_alignment(GuiAlignment a) { m_alignment = a; m_pos_mode = PositionMode::Aligned; }
+    void set_alignment(GuiAlignment a) { m_alignment = a; m_pos_mode = PositionMode::Aligned; mark_layout_dirty(); }
     GuiAlignment alignment() const { return m_alignment; }
-    void clear_alignment() { m_pos_mode = PositionMode::Manual; }
+    void clear_alignment() { m_pos_mode = PositionMode::Manual; mark_layout_dirty(); }
     PositionMode position_mode() const { return m_pos_mode; }
 
     // Offset (margin) applied from the chosen anchor in pixels or percent of parent size.
@@ -57,15 +60,72 @@ public:
     // For right/top anchors: positive offsets move inward from the edge.
     void set_anchor_offset(float dx, float dy, bool in_percentage = false) {
         m_anchor_dx = dx; m_anchor_dy = dy; m_anchor_is_percent = in_percentage;
+        mark_layout_dirty();
     }
 
     // Visibility
-    void show() { m_visible = true; }
-    void hide() { m_visible = false; }
+    void show() { if (!m_visible) { m_visible = true; m_rect.valid = false; mark_layout_dirty(); } }
+    void hide() { if (m_visible) { m_visible = false; mark_layout_dirty(); } }
     bool visible() const { return m_visible; }
 
-    // Rendering contract
-    virtual void draw() = 0;
+    // Retained layout: containers keep each child's measured size and their
+    // arrangement until something changes. Setters that can change an
+    // element's preferred size or placement call mark_layout_dirty(), which
+    // also dirties every container above it; a container whose subtree is
+    // clean (and whose rect did not move) skips layout.
+    void mark_layout_dirty();
+    // preferred_size(), recomputed only when dirty (percentage sizes: always)
+    std::pair<float,float> measure();
+    GuiElement* layout_parent() const { return m_layout_parent.ptr; }
+    void set_layout_parent(GuiElement* parent) { m_layout_parent.ptr = parent; } // set by containers
+    // Containers: `child` is being destroyed (called from ~GuiElement)
+    virtual void remove_layout_child(GuiElement* child) { (void)child; }
+
+    // Flex item properties (GuiPanel FLEX layout): share of the free main
+    // space taken when there is some (grow) or given up when items overflow
+    // (shrink, weighted by item size), and size bounds (0 = unbounded).
+    void set_flex(float grow, float shrink = 1.0f) {
+        m_flex_grow = grow < 0.f ? 0.f : grow; m_flex_shrink = shrink < 0.f ? 0.f : shrink;
+        mark_layout_dirty();
+    }
+    void set_min_size(float w, float h) { m_min_w = w; m_min_h = h; mark_layout_dirty(); }
+    void set_max_size(float w, float h) { m_max_w = w; m_max_h = h; mark_layout_dirty(); }
+    float flex_grow() const { return m_flex_grow; }
+    float flex_shrink() const { return m_flex_shrink; }
+    std::pair<float,float> min_size() const { return {m_min_w, m_min_h}; }
+    std::pair<float,float> max_size() const { return {m_max_w, m_max_h}; }
+    // Size assigned by the container (flex grow/shrink/stretch); 0 = none.
+    // Draws use it instead of set_size(); preferred_size() does not.
+    void set_layout_size(float w, float h) { m_layout_w = w; m_layout_h = h; }
+
+    // Pointer routing: update() adds the rect(s) this element takes the
+    // pointer in to the frame's GuiHitTest; the next frame's input.hover is
+    // this element when it is the topmost one under the pointer. Overlay
+    // rects (popups) are above all others.
+    void add_hit_rect(float x, float y, float w, float h, bool overlay = false);
+
+    // Culling: true when the rect is entirely outside the viewport or the
+    // clip of the containers being updated (GuiHitTest clip stack). update()
+    // of a culled element skips its input, glyph and layout work and leaves
+    // nothing for draw().
+    static bool culled(float x, float y, float w, float h);
+
+    struct LayoutCounters {
+        int measured = 0; // preferred_size() calls made by measure()
+        int arranged = 0; // children placed by containers
+        int culled = 0;   // elements skipped by update(): off screen or clipped out
+    };
+    static const LayoutCounters& frame_layout_counters();   // last completed frame
+    static const LayoutCounters& current_layout_counters(); // frame in progress
+    static void count_arranged(int children);
+
+    // Frame contract: update() handles input, state and layout (containers
+    // arrange and then update their children); draw() const only emits the
+    // geometry that update() prepared into the GuiDraw list. Call
+    // GuiDraw::begin_frame, update the tree, GuiText::finalize_frame(), then
+    // draw it.
+    virtual void update(float dt, GuiInputState& input) { (void)dt; (void)input; }
+    virtual void draw() const = 0;
 
     // Preferred content size in pixels. Default uses set_size if provided, otherwise {0,0}.
     virtual std::pair<float,float> preferred_size() const {
@@ -232,12 +292,11 @@ public:
     }
 
 protected:
-    // Convert stored position/size to pixels using current GL viewport
+    // Convert stored position/size to pixels using the framebuffer size of the
+    // current GuiFrameContext (no GL query)
     static void get_framebuffer_size(int& out_w, int& out_h) {
-        // Query GL viewport to get pixel size when not explicitly notified
-        int vp[4] = {0,0,0,0};
-        glGetIntegerv(GL_VIEWPORT, vp);
-        out_w = vp[2]; out_h = vp[3];
+        const GuiFrameContext& ctx = GuiFrameContext::current();
+        out_w = ctx.fb_width; out_h = ctx.fb_height;
     }
 
     float pixel_x() const {
@@ -261,6 +320,9 @@ protected:
         int fw=0, fh=0; get_framebuffer_size(fw, fh);
         return m_size_h * 0.01f * static_cast<float>(fh);
     }
+    // Size to draw at: the container's when it assigned one, else pixel_w/h
+    float box_w() const { return m_layout_w > 0.0f ? m_layout_w : pixel_w(); }
+    float box_h() const { return m_layout_h > 0.0f ? m_layout_h : pixel_h(); }
 
 protected:
     float m_pos_x = 0.0f;
@@ -273,6 +335,34 @@ protected:
 
     bool  m_visible = true;
 
+    // Retained layout state. The container link is not carried over by
+    // moves: the container still lists the original object.
+    struct LayoutParent {
+        GuiElement* ptr = nullptr;
+        LayoutParent() = default;
+        LayoutParent(LayoutParent&&) noexcept {}
+        LayoutParent& operator=(LayoutParent&&) noexcept { return *this; }
+    };
+    LayoutParent m_layout_parent;
+    bool  m_measure_dirty = true;  // m_measured is stale
+    bool  m_layout_dirty = true;   // containers: children must be arranged again
+    std::pair<float,float> m_measured{0.0f, 0.0f};
+    float m_layout_w = 0.0f;
+    float m_layout_h = 0.0f;
+    float m_flex_grow = 0.0f;
+    float m_flex_shrink = 1.0f;
+    float m_min_w = 0.0f, m_min_h = 0.0f;
+    float m_max_w = 0.0f, m_max_h = 0.0f;
+
+    // Pixel rect resolved by update() (alignment and animation applied) for
+    // draw(); invalid when there is nothing to draw
+    struct DrawRect {
+        float x = 0.0f, y = 0.0f, w = 0.0f, h = 0.0f;
+        bool valid = false;
+    };
+    DrawRect m_rect;
+    unsigned long m_hit_frame = 0; // GuiHitTest frame until which a rect of ours is held
+
     // Per-frame animation accumulation and active animations
     AnimState m_anim{};
     std::vector<std::unique_ptr<Animation, AnimDeleter>> m_animations;
@@ -0,0 +1,80 @@
+// GuiFontBake.h - Binary layout of baked font atlases (mge_fontbake -> GuiText)
+#pragma once
+
+#include <cstdint>
+
+// A .mgef file holds pre-rasterized glyph atlases, one per (font, size):
+//
+//   FileHeader
+//   FontHeader[font_count]
+//   per font, at the offsets of its header (8-byte aligned):
+//     path bytes (font path as passed to set_text_font, not NUL-terminated)
+//     GlyphRecord[glyph_count]
+//     ShelfRecord[shelf_count]  (packer state, so glyphs can be added later)
+//     KernRecord[kern_count]    (kerning of the font file, kFlagKerning only)
+//     atlas pixels, atlas_width * atlas_height bytes (GL_R8 rows, top first)
+//
+// Offsets are from the start of the file. Integers are little-endian: files
+// are baked on the build machine for the same platform.
+namespace GuiFontBake {
+
+constexpr char kMagic[4] = {'M', 'G', 'E', 'F'};
+constexpr std::uint32_t kVersion = 2;
+constexpr std::uint32_t kFlagSdf = 1u;
+constexpr std::uint32_t kFlagKerning = 2u; // carries the font's kerning pairs (first size of each file)
+
+struct FileHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t font_count;
+    std::uint32_t reserved;
+};
+
+struct FontHeader {
+    std::uint32_t path_offset;
+    std::uint32_t path_length;
+    std::int32_t pixel_size;      // raster size (GuiSdf::kGlyphBasePx for SDF)
+    std::uint32_t flags;          // kFlagSdf | kFlagKerning
+    std::int32_t atlas_width;
+    std::int32_t atlas_height;
+    std::uint32_t glyph_count;
+    std::uint32_t glyphs_offset;
+    std::uint32_t shelf_count;
+    std::uint32_t shelves_offset;
+    std::uint32_t pixels_offset;
+    std::int32_t units_per_em;    // kerning values are in font units
+    std::uint32_t kern_count;
+    std::uint32_t kern_offset;
+    std::uint32_t reserved[2];
+};
+
+struct GlyphRecord {
+    std::uint32_t codepoint;
+    std::uint16_t x, y, w, h;     // rect in the atlas
+    std::int16_t bearing_x;
+    std::int16_t bearing_y;
+    std::uint32_t advance;        // 1/64 pixels
+    std::int16_t pad;             // SDF spread (0 for coverage glyphs)
+    std::uint16_t glyph_index;    // FreeType glyph id (kerning key)
+};
+
+struct ShelfRecord {
+    std::int32_t y;
+    std::int32_t height;
+    std::int32_t cursor_x;
+};
+
+struct KernRecord {
+    std::uint16_t left;           // glyph ids
+    std::uint16_t right;
+    std::int16_t value;           // x advance adjustment, font units
+    std::uint16_t reserved;
+};
+
+static_assert(sizeof(FileHeader) == 16, "FileHeader layout");
+static_assert(sizeof(FontHeader) == 64, "FontHeader layout");
+static_assert(sizeof(GlyphRecord) == 24, "GlyphRecord layout");
+static_assert(sizeof(ShelfRecord) == 12, "ShelfRecord layout");
+static_assert(sizeof(KernRecord) == 8, "KernRecord layout");
+
+} // namespace GuiFontBake
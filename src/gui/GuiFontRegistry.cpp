@@ -0,0 +1,206 @@
+// GuiFontRegistry.cpp - Implementation of the font registry
+
+#include "GuiFontRegistry.h"
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_SIZES_H
+
+#include <cstdio>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+GuiFontRegistry& GuiFontRegistry::instance()
+{
+    static GuiFontRegistry inst;
+    return inst;
+}
+
+GuiFontRegistry::~GuiFontRegistry()
+{
+    for (Font& f : m_fonts) {
+        if (f.face) FT_Done_Face(reinterpret_cast<FT_Face>(f.face)); // also frees its sizes
+        unmap_file(f.file);
+    }
+    if (m_library) FT_Done_FreeType(reinterpret_cast<FT_Library>(m_library));
+}
+
+void* GuiFontRegistry::library()
+{
+    if (m_library) return m_library;
+    FT_Library lib = nullptr;
+    if (FT_Init_FreeType(&lib) != 0) {
+        std::fprintf(stderr, "[GuiFontRegistry] FreeType init failed.\n");
+        return nullptr;
+    }
+    m_library = lib;
+    return m_library;
+}
+
+bool GuiFontRegistry::map_file(const std::string& path, MappedFile& out)
+{
+    out = MappedFile();
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) { CloseHandle(file); return false; }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file); // the mapping keeps the file open
+    if (!mapping) return false;
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) { CloseHandle(mapping); return false; }
+    out.data = static_cast<const unsigned char*>(view);
+    out.size = static_cast<std::size_t>(size.QuadPart);
+    out.handle = mapping;
+    return true;
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) { close(fd); return false; }
+    void* addr = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping stays valid
+    if (addr == MAP_FAILED) return false;
+    out.data = static_cast<const unsigned char*>(addr);
+    out.size = static_cast<std::size_t>(st.st_size);
+    return true;
+#endif
+}
+
+void GuiFontRegistry::unmap_file(MappedFile& file)
+{
+    if (!file.data) return;
+#if defined(_WIN32)
+    UnmapViewOfFile(file.data);
+    if (file.handle) CloseHandle(static_cast<HANDLE>(file.handle));
+#else
+    munmap(const_cast<unsigned char*>(file.data), file.size);
+#endif
+    file = MappedFile();
+}
+
+bool GuiFontRegistry::open(Font& f)
+{
+    if (f.face) return true;
+    if (f.open_failed) return false; // reported once
+    f.open_failed = true;
+
+    FT_Library lib = reinterpret_cast<FT_Library>(library());
+    if (!lib) return false;
+    if (!map_file(f.path, f.file)) {
+        std::fprintf(stderr, "[GuiFontRegistry] Failed to map font file: %s\n", f.path.c_str());
+        return false;
+    }
+    FT_Face face = nullptr;
+    if (FT_New_Memory_Face(lib, f.file.data, static_cast<FT_Long>(f.file.size), 0, &face) != 0) {
+        std::fprintf(stderr, "[GuiFontRegistry] Failed to load font face: %s\n", f.path.c_str());
+        unmap_file(f.file);
+        return false;
+    }
+    f.face = face;
+    f.open_failed = false;
+    return true;
+}
+
+FontId GuiFontRegistry::load(const std::string& path)
+{
+    auto it = m_by_path.find(path);
+    if (it != m_by_path.end()) return it->second;
+    if (path.empty()) return kInvalidFontId;
+
+    Font f;
+    f.path = path;
+    if (!open(f)) return kInvalidFontId;
+
+    const FontId id = static_cast<FontId>(m_fonts.size());
+    m_fonts.push_back(std::move(f));
+    m_by_path.emplace(path, id);
+    return id;
+}
+
+FontId GuiFontRegistry::reserve(const std::string& path)
+{
+    auto it = m_by_path.find(path);
+    if (it != m_by_path.end()) return it->second;
+    if (path.empty()) return kInvalidFontId;
+
+    Font f;
+    f.path = path;
+    const FontId id = static_cast<FontId>(m_fonts.size());
+    m_fonts.push_back(std::move(f));
+    m_by_path.emplace(path, id);
+    return id;
+}
+
+bool GuiFontRegistry::activate(FontId id, int pixel_size)
+{
+    if (id < 0 || id >= static_cast<FontId>(m_fonts.size())) return false;
+    Font& f = m_fonts[static_cast<std::size_t>(id)];
+    if (f.active_px == pixel_size) return true;
+    if (!open(f)) return false;
+
+    FT_Face face = reinterpret_cast<FT_Face>(f.face);
+    auto it = f.sizes.find(pixel_size);
+    if (it == f.sizes.end()) {
+        FT_Size size = nullptr;
+        if (FT_New_Size(face, &size) != 0) {
+            std::fprintf(stderr, "[GuiFontRegistry] FT_New_Size failed for %s\n", f.path.c_str());
+            return false;
+        }
+        FT_Activate_Size(size);
+        FT_Set_Pixel_Sizes(face, 0, static_cast<FT_UInt>(pixel_size));
+        it = f.sizes.emplace(pixel_size, size).first;
+    } else {
+        FT_Activate_Size(reinterpret_cast<FT_Size>(it->second));
+    }
+    f.active_px = pixel_size;
+    return true;
+}
+
+unsigned int GuiFontRegistry::char_index(FontId id, unsigned long codepoint)
+{
+    if (id < 0 || id >= static_cast<FontId>(m_fonts.size())) return 0;
+    Font& f = m_fonts[static_cast<std::size_t>(id)];
+    if (!open(f)) return 0;
+    return FT_Get_Char_Index(reinterpret_cast<FT_Face>(f.face), static_cast<FT_ULong>(codepoint));
+}
+
+void* GuiFontRegistry::face(FontId id) const
+{
+    if (id < 0 || id >= static_cast<FontId>(m_fonts.size())) return nullptr;
+    return m_fonts[static_cast<std::size_t>(id)].face;
+}
+
+const std::string& GuiFontRegistry::path(FontId id) const
+{
+    static const std::string empty;
+    if (id < 0 || id >= static_cast<FontId>(m_fonts.size())) return empty;
+    return m_fonts[static_cast<std::size_t>(id)].path;
+}
+
+bool GuiFontRegistry::file_data(FontId id, const unsigned char*& data, std::size_t& size) const
+{
+    data = nullptr;
+    size = 0;
+    if (id < 0 || id >= static_cast<FontId>(m_fonts.size())) return false;
+    const Font& f = m_fonts[static_cast<std::size_t>(id)];
+    data = f.file.data;
+    size = f.file.size;
+    return data != nullptr;
+}
+
+std::size_t GuiFontRegistry::mapped_bytes() const
+{
+    std::size_t total = 0;
+    for (const Font& f : m_fonts) total += f.file.size;
+    return total;
+}
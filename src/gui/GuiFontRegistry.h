@@ -0,0 +1,72 @@
+// GuiFontRegistry.h - Process-wide font files, FreeType faces and sizes
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using FontId = int;
+constexpr FontId kInvalidFontId = -1;
+
+// Every font file is memory-mapped once and opened as a single FT_Face
+// (FT_New_Memory_Face, no re-parsing per size). Each pixel size gets its own
+// FT_Size on that face; activate() selects it before loading glyphs.
+// Widgets refer to fonts by FontId, so caches key on small integers instead of
+// path strings. FreeType types are exposed as void* to keep ft headers out.
+class GuiFontRegistry {
+public:
+    static GuiFontRegistry& instance();
+
+    // Map and open `path` (or return the id it already has). kInvalidFontId on failure.
+    FontId load(const std::string& path);
+    // Id for `path` without touching the file: it is mapped and opened on the
+    // first activate() (fonts served from a baked atlas may never need it)
+    FontId reserve(const std::string& path);
+
+    // Make `pixel_size` the active size of the font's face (created on first use).
+    // Opens a reserved font.
+    bool activate(FontId id, int pixel_size);
+
+    // Glyph index of `codepoint` in the font's cmap (0: not in the font).
+    // Opens a reserved font.
+    unsigned int char_index(FontId id, unsigned long codepoint);
+
+    void* face(FontId id) const;       // FT_Face
+    void* library();                   // FT_Library (initialized on first call)
+    const std::string& path(FontId id) const;
+    // Mapped file bytes (read only, valid for the process lifetime), e.g. for
+    // worker threads that open their own FT_Face on the same memory
+    bool file_data(FontId id, const unsigned char*& data, std::size_t& size) const;
+    std::size_t mapped_bytes() const;  // total size of the mapped font files
+
+    // Read-only file mapping (mmap / MapViewOfFile)
+    struct MappedFile {
+        const unsigned char* data = nullptr;
+        std::size_t size = 0;
+        void* handle = nullptr;              // platform handle (Windows file mapping)
+    };
+    static bool map_file(const std::string& path, MappedFile& out);
+    static void unmap_file(MappedFile& file);
+
+private:
+    GuiFontRegistry() = default;
+    ~GuiFontRegistry();
+    GuiFontRegistry(const GuiFontRegistry&) = delete;
+    GuiFontRegistry& operator=(const GuiFontRegistry&) = delete;
+
+    struct Font {
+        std::string path;
+        MappedFile file;
+        void* face = nullptr;                // FT_Face
+        std::unordered_map<int, void*> sizes; // pixel size -> FT_Size
+        int active_px = 0;
+        bool open_failed = false;
+    };
+
+    bool open(Font& f);
+
+    void* m_library = nullptr;
+    std::vector<Font> m_fonts;                          // index = FontId
+    std::unordered_map<std::string, FontId> m_by_path;
+};
@@ -0,0 +1,48 @@
+// GuiFrameContext.cpp - Implementation of GuiFrameContext
+
+#include "GuiFrameContext.h"
+
+namespace {
+
+// Simple orthographic projection matrix, origin at bottom-left, z range [-1,1]
+static void make_ortho(float left, float right, float bottom, float top, float znear, float zfar, float out[16])
+{
+    for (int i=0;i<16;++i) out[i] = 0.0f;
+    out[0] = 2.0f / (right - left);
+    out[5] = 2.0f / (top - bottom);
+    out[10] = -2.0f / (zfar - znear);
+    out[12] = - (right + left) / (right - left);
+    out[13] = - (top + bottom) / (top - bottom);
+    out[14] = - (zfar + znear) / (zfar - znear);
+    out[15] = 1.0f;
+}
+
+static GuiFrameContext s_current{};
+
+} // namespace
+
+GuiFrameContext GuiFrameContext::make(int fb_width, int fb_height, float content_scale_x, float content_scale_y,
+                                      double time, float dt, bool scene_depth_test,
+                                      const float* perspective)
+{
+    GuiFrameContext ctx;
+    ctx.fb_width = fb_width;
+    ctx.fb_height = fb_height;
+    // Guard against minimized windows (0x0 framebuffer)
+    const float w = fb_width > 0 ? static_cast<float>(fb_width) : 1.0f;
+    const float h = fb_height > 0 ? static_cast<float>(fb_height) : 1.0f;
+    make_ortho(0.0f, w, 0.0f, h, -1.0f, 1.0f, ctx.ortho);
+    for (int i=0;i<16;++i) {
+        ctx.perspective[i] = perspective ? perspective[i] : ((i % 5 == 0) ? 1.0f : 0.0f);
+    }
+    ctx.content_scale_x = content_scale_x;
+    ctx.content_scale_y = content_scale_y;
+    ctx.time = time;
+    ctx.dt = dt;
+    ctx.scene_depth_test = scene_depth_test;
+    return ctx;
+}
+
+const GuiFrameContext& GuiFrameContext::current() { return s_current; }
+
+void GuiFrameContext::set_current(const GuiFrameContext& ctx) { s_current = ctx; }
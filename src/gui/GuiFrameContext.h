@@ -0,0 +1,32 @@
+// GuiFrameContext.h - Per-frame GUI state built once by the application loop
+#pragma once
+
+// Everything the GUI needs to know about the current frame, gathered once per
+// frame by the application (no GL queries on the GUI hot path).
+// Build it with make(), publish it with set_current() (once per frame, by the
+// application loop only), then hand it to AnimationManager::update and
+// GuiDraw::begin_frame before the update and draw passes.
+// Widgets read the framebuffer size through current() rather than an
+// update()/draw() argument: percent positions and alignment are resolved by
+// const queries (pixel_x(), compute_aligned_xy(), preferred_size()) that
+// containers also call outside of those passes.
+// GuiFrameUniforms::update uploads it for shaders (FrameData uniform block).
+struct GuiFrameContext {
+    int   fb_width = 0;             // framebuffer size in pixels (= viewport)
+    int   fb_height = 0;
+    float ortho[16] = {};           // pixel-space projection, origin bottom-left, z in [-1,1]
+    float perspective[16] = {};     // scene projection (identity when not provided)
+    float content_scale_x = 1.0f;   // window content scale (HiDPI)
+    float content_scale_y = 1.0f;
+    double time = 0.0;              // seconds since start
+    float dt = 0.0f;                // seconds since previous frame
+    bool  scene_depth_test = false; // depth test state the GUI pass must restore
+
+    static GuiFrameContext make(int fb_width, int fb_height, float content_scale_x, float content_scale_y,
+                                double time, float dt, bool scene_depth_test,
+                                const float* perspective = nullptr);
+
+    // Context of the frame in progress (zero-sized until the first set_current)
+    static const GuiFrameContext& current();
+    static void set_current(const GuiFrameContext& ctx);
+};
@@ -0,0 +1,78 @@
+// GuiFrameUniforms.cpp - Implementation of the per-frame uniform block
+
+#include "GuiFrameUniforms.h"
+#include "GuiFrameContext.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+static GLuint s_ubo = 0;
+static GuiFrameUniforms::FrameBlock s_last{};
+static bool s_has_last = false;
+
+static_assert(sizeof(GuiFrameUniforms::FrameBlock) == 160, "FrameBlock must match the std140 layout");
+
+static void fill_block(const GuiFrameContext& ctx, GuiFrameUniforms::FrameBlock& b)
+{
+    std::memcpy(b.ortho, ctx.ortho, sizeof(b.ortho));
+    std::memcpy(b.perspective, ctx.perspective, sizeof(b.perspective));
+    b.viewport[0] = 0.0f;
+    b.viewport[1] = 0.0f;
+    b.viewport[2] = static_cast<float>(ctx.fb_width);
+    b.viewport[3] = static_cast<float>(ctx.fb_height);
+    b.time[0] = static_cast<float>(ctx.time);
+    b.time[1] = ctx.dt;
+    b.time[2] = ctx.content_scale_x;
+    b.time[3] = ctx.content_scale_y;
+}
+
+} // namespace
+
+namespace GuiFrameUniforms {
+
+bool update(const GuiFrameContext& ctx)
+{
+    if (s_ubo == 0) {
+        glGenBuffers(1, &s_ubo);
+        if (s_ubo == 0) {
+            std::fprintf(stderr, "[GuiFrameUniforms] Failed to create uniform buffer.\n");
+            return false;
+        }
+        glBindBuffer(GL_UNIFORM_BUFFER, s_ubo);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameBlock), nullptr, GL_DYNAMIC_DRAW);
+        s_has_last = false;
+    }
+
+    FrameBlock b;
+    fill_block(ctx, b);
+    if (!s_has_last || std::memcmp(&b, &s_last, sizeof(b)) != 0) {
+        glBindBuffer(GL_UNIFORM_BUFFER, s_ubo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameBlock), &b);
+        s_last = b;
+        s_has_last = true;
+    }
+    glBindBufferBase(GL_UNIFORM_BUFFER, kBindingPoint, s_ubo);
+    return true;
+}
+
+bool bind_program(GLuint program)
+{
+    if (program == 0) return false;
+    const GLuint index = glGetUniformBlockIndex(program, "FrameData");
+    if (index == GL_INVALID_INDEX) {
+        std::fprintf(stderr, "[GuiFrameUniforms] Program %u has no FrameData block.\n", program);
+        return false;
+    }
+    glUniformBlockBinding(program, index, kBindingPoint);
+    return true;
+}
+
+void shutdown()
+{
+    if (s_ubo) { glDeleteBuffers(1, &s_ubo); s_ubo = 0; }
+    s_has_last = false;
+}
+
+} // namespace GuiFrameUniforms
@@ -0,0 +1,42 @@
+// GuiFrameUniforms.h - Per-frame std140 uniform block shared by GUI and scene shaders
+#pragma once
+
+#include <glad/glad.h>
+
+struct GuiFrameContext;
+
+// One uniform buffer holding the data every program needs once per frame.
+// GLSL side (keep in sync with FrameBlock below):
+//
+//   layout(std140) uniform FrameData {
+//       mat4 uOrtho;        // pixel-space projection (GUI)
+//       mat4 uPerspective;  // scene projection
+//       vec4 uViewport;     // x, y, width, height in pixels
+//       vec4 uTime;         // time, dt, content scale x, content scale y
+//   };
+//
+// update() is called once per frame by the application loop and uploads only
+// when the data changed; programs attach to the block with bind_program().
+namespace GuiFrameUniforms {
+
+// Uniform buffer binding point reserved for FrameData
+constexpr GLuint kBindingPoint = 0;
+
+// std140 mirror of the GLSL block
+struct FrameBlock {
+    float ortho[16];
+    float perspective[16];
+    float viewport[4];
+    float time[4];
+};
+
+// Upload ctx into the buffer (skipped when identical to the previous upload)
+// and bind it to kBindingPoint.
+bool update(const GuiFrameContext& ctx);
+// Attach the program's FrameData block to kBindingPoint. Returns false when the
+// program has no such block.
+bool bind_program(GLuint program);
+// Release the GL buffer (safe to call without a current buffer)
+void shutdown();
+
+} // namespace GuiFrameUniforms
@@ -0,0 +1,150 @@
+// GuiGlState.cpp - Implementation of the GUI GL state shadow
+
+#include "GuiGlState.h"
+
+namespace {
+
+constexpr int kMaxUnits = 16;
+constexpr unsigned int kUnknown = 0xFFFFFFFFu; // never a valid GL name/enum here
+
+struct Shadow {
+    unsigned int program = kUnknown;
+    unsigned int vao = kUnknown;
+    unsigned int array_buffer = kUnknown;
+    unsigned int active_unit = kUnknown;
+    unsigned int textures[kMaxUnits];
+    int blend = -1;          // -1 unknown, 0 off, 1 on
+    unsigned int blend_src = kUnknown;
+    unsigned int blend_dst = kUnknown;
+    int depth_test = -1;
+    int scissor_test = -1;
+    int scissor_box[4] = {-1, -1, -1, -1};
+    Shadow() { for (auto& t : textures) t = kUnknown; }
+};
+
+static Shadow s_shadow;
+static GuiGlState::Counters s_cur{};
+static GuiGlState::Counters s_last{};
+
+// Returns true when the call must be issued (and records the new value)
+static bool changed(unsigned int& slot, unsigned int value)
+{
+    if (slot == value) { s_cur.skipped += 1; return false; }
+    slot = value;
+    s_cur.issued += 1;
+    return true;
+}
+
+static bool changed(int& slot, int value)
+{
+    if (slot == value) { s_cur.skipped += 1; return false; }
+    slot = value;
+    s_cur.issued += 1;
+    return true;
+}
+
+} // namespace
+
+namespace GuiGlState {
+
+void use_program(GLuint program)
+{
+    if (changed(s_shadow.program, program)) glUseProgram(program);
+}
+
+void bind_vertex_array(GLuint vao)
+{
+    if (changed(s_shadow.vao, vao)) glBindVertexArray(vao);
+}
+
+void bind_array_buffer(GLuint buffer)
+{
+    if (changed(s_shadow.array_buffer, buffer)) glBindBuffer(GL_ARRAY_BUFFER, buffer);
+}
+
+void bind_texture_2d(int unit, GLuint texture)
+{
+    if (unit < 0 || unit >= kMaxUnits) return;
+    if (s_shadow.textures[unit] == texture) { s_cur.skipped += 1; return; }
+    if (changed(s_shadow.active_unit, static_cast<unsigned int>(unit))) glActiveTexture(GL_TEXTURE0 + static_cast<GLenum>(unit));
+    s_shadow.textures[unit] = texture;
+    s_cur.issued += 1;
+    glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+void set_blend(bool enabled)
+{
+    if (changed(s_shadow.blend, enabled ? 1 : 0)) {
+        if (enabled) glEnable(GL_BLEND); else glDisable(GL_BLEND);
+    }
+}
+
+void blend_func(GLenum src, GLenum dst)
+{
+    if (s_shadow.blend_src == src && s_shadow.blend_dst == dst) { s_cur.skipped += 1; return; }
+    s_shadow.blend_src = src;
+    s_shadow.blend_dst = dst;
+    s_cur.issued += 1;
+    glBlendFunc(src, dst);
+}
+
+void set_depth_test(bool enabled)
+{
+    if (changed(s_shadow.depth_test, enabled ? 1 : 0)) {
+        if (enabled) glEnable(GL_DEPTH_TEST); else glDisable(GL_DEPTH_TEST);
+    }
+}
+
+void set_scissor_test(bool enabled)
+{
+    if (changed(s_shadow.scissor_test, enabled ? 1 : 0)) {
+        if (enabled) glEnable(GL_SCISSOR_TEST); else glDisable(GL_SCISSOR_TEST);
+    }
+}
+
+void scissor(GLint x, GLint y, GLsizei w, GLsizei h)
+{
+    int* box = s_shadow.scissor_box;
+    if (box[0] == x && box[1] == y && box[2] == w && box[3] == h) { s_cur.skipped += 1; return; }
+    box[0] = x; box[1] = y; box[2] = w; box[3] = h;
+    s_cur.issued += 1;
+    glScissor(x, y, w, h);
+}
+
+void forget_texture(GLuint texture)
+{
+    for (auto& t : s_shadow.textures) if (t == texture) t = 0;
+}
+
+void forget_buffer(GLuint buffer)
+{
+    if (s_shadow.array_buffer == buffer) s_shadow.array_buffer = 0;
+}
+
+void forget_vertex_array(GLuint vao)
+{
+    if (s_shadow.vao == vao) s_shadow.vao = 0;
+}
+
+void forget_program(GLuint program)
+{
+    // A deleted program stays in use until another one is bound
+    if (s_shadow.program == program) s_shadow.program = kUnknown;
+}
+
+void invalidate()
+{
+    s_shadow = Shadow{};
+}
+
+void begin_frame()
+{
+    s_last = s_cur;
+    s_cur = Counters{};
+    invalidate();
+}
+
+const Counters& frame_counters() { return s_last; }
+const Counters& current_counters() { return s_cur; }
+
+} // namespace GuiGlState
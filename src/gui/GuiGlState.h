@@ -0,0 +1,43 @@
+// GuiGlState.h - Shadow of the GL state touched by the GUI renderers
+#pragma once
+
+#include <glad/glad.h>
+
+// Every GUI renderer binds programs, VAOs, buffers and textures and sets blend /
+// depth / scissor state through these helpers. Each call is compared with a shadow copy
+// and only reaches GL when the value actually changes.
+// Code outside the GUI (scene rendering) is free to use raw GL: invalidate()
+// (called by GuiDraw::begin_frame) forgets the shadow so the next call re-issues.
+namespace GuiGlState {
+
+void use_program(GLuint program);
+void bind_vertex_array(GLuint vao);
+void bind_array_buffer(GLuint buffer);
+// Bind a GL_TEXTURE_2D on the given unit (switches the active unit if needed)
+void bind_texture_2d(int unit, GLuint texture);
+void set_blend(bool enabled);
+void blend_func(GLenum src, GLenum dst);
+void set_depth_test(bool enabled);
+void set_scissor_test(bool enabled);
+void scissor(GLint x, GLint y, GLsizei w, GLsizei h);
+
+// Names about to be deleted: GL resets their bindings to 0, the shadow must too
+void forget_texture(GLuint texture);
+void forget_buffer(GLuint buffer);
+void forget_vertex_array(GLuint vao);
+void forget_program(GLuint program);
+
+// Forget every shadowed value (state unknown: next call of each kind is issued)
+void invalidate();
+
+// Roll the per-frame counters and invalidate the shadow
+void begin_frame();
+
+struct Counters {
+    int issued = 0;  // calls forwarded to GL
+    int skipped = 0; // redundant calls filtered out
+};
+const Counters& frame_counters();   // last completed frame
+const Counters& current_counters(); // frame in progress
+
+} // namespace GuiGlState
@@ -0,0 +1,46 @@
+// GuiGlyphAtlas.cpp - GL texture of the shelf-packed glyph atlas
+
+#include "GuiGlyphAtlas.h"
+#include "GuiGlState.h"
+
+#include <cstddef>
+
+GuiGlyphAtlas::~GuiGlyphAtlas()
+{
+    if (m_tex) { GuiGlState::forget_texture(m_tex); glDeleteTextures(1, &m_tex); }
+}
+
+GLuint GuiGlyphAtlas::texture()
+{
+    if (m_tex == 0) {
+        glGenTextures(1, &m_tex);
+        GuiGlState::bind_texture_2d(0, m_tex);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        GLint swizzleMask[] = {GL_RED, GL_RED, GL_RED, GL_RED};
+        glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzleMask);
+        m_tex_w = 0;
+        m_tex_h = 0;
+    }
+
+    int y0 = 0, y1 = 0;
+    const bool dirty = dirty_rows(y0, y1);
+    const bool full = (m_tex_w != width() || m_tex_h != height());
+    if (!full && !dirty) return m_tex;
+
+    GuiGlState::bind_texture_2d(0, m_tex);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (full) {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width(), height(), 0, GL_RED, GL_UNSIGNED_BYTE, pixels());
+        m_tex_w = width();
+        m_tex_h = height();
+    } else {
+        // Only the changed band of rows (full width keeps rows contiguous)
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y0, width(), y1 - y0,
+                        GL_RED, GL_UNSIGNED_BYTE, pixels() + static_cast<std::size_t>(y0) * width());
+    }
+    clear_dirty();
+    return m_tex;
+}
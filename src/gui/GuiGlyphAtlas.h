@@ -0,0 +1,26 @@
+// GuiGlyphAtlas.h - Single-channel texture atlas with a shelf packer (glyph bitmaps)
+#pragma once
+
+#include <glad/glad.h>
+#include "GuiAtlasPacker.h"
+
+// GuiAtlasPacker layout uploaded to one GL_R8 texture.
+// - Pixels live in the packer's CPU copy; texture() uploads the rows touched
+//   since the last call (whole texture after a resize). The GL texture name
+//   never changes.
+// - restore() (baked layout) is uploaded by the next texture() in one
+//   glTexImage2D.
+class GuiGlyphAtlas : public GuiAtlasPacker {
+public:
+    explicit GuiGlyphAtlas(int initial_size = 256, int max_size = 4096)
+        : GuiAtlasPacker(initial_size, max_size) {}
+    ~GuiGlyphAtlas();
+
+    // GL texture with pending pixels uploaded (creates it on first call)
+    GLuint texture();
+
+private:
+    GLuint m_tex = 0;
+    int m_tex_w = 0;          // size of the GL storage (0 => needs full upload)
+    int m_tex_h = 0;
+};
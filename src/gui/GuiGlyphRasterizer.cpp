@@ -0,0 +1,181 @@
+// GuiGlyphRasterizer.cpp - Implementation of the glyph worker pool
+
+#include "GuiGlyphRasterizer.h"
+#include "GuiSdf.h"
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <system_error>
+#include <unordered_map>
+
+namespace {
+
+// FreeType state private to one worker thread
+struct WorkerFonts {
+    FT_Library library = nullptr;
+    struct Face { FT_Face face = nullptr; int pixel_size = 0; };
+    std::unordered_map<FontId, Face> faces;
+
+    ~WorkerFonts()
+    {
+        for (auto& kv : faces) FT_Done_Face(kv.second.face);
+        if (library) FT_Done_FreeType(library);
+    }
+
+    FT_Face face_for(const GuiGlyphRasterizer::Job& job)
+    {
+        if (!library && FT_Init_FreeType(&library) != 0) {
+            library = nullptr;
+            return nullptr;
+        }
+        Face& f = faces[job.font];
+        if (!f.face) {
+            if (FT_New_Memory_Face(library, job.file_data, static_cast<FT_Long>(job.file_size), 0, &f.face) != 0) {
+                f.face = nullptr;
+                return nullptr;
+            }
+        }
+        if (f.pixel_size != job.pixel_size) {
+            FT_Set_Pixel_Sizes(f.face, 0, static_cast<FT_UInt>(job.pixel_size));
+            f.pixel_size = job.pixel_size;
+        }
+        return f.face;
+    }
+};
+
+static void rasterize(WorkerFonts& fonts, GuiGlyphRasterizer::Result& r)
+{
+    const GuiGlyphRasterizer::Job& job = r.job;
+    FT_Face face = fonts.face_for(job);
+    if (!face || FT_Load_Char(face, static_cast<FT_ULong>(job.codepoint), FT_LOAD_RENDER) != 0) return;
+
+    FT_GlyphSlot g = face->glyph;
+    const int w = static_cast<int>(g->bitmap.width);
+    const int h = static_cast<int>(g->bitmap.rows);
+    r.bearing_x = g->bitmap_left;
+    r.bearing_y = g->bitmap_top;
+    r.advance = static_cast<unsigned int>(g->advance.x);
+    r.ok = true;
+    if (w <= 0 || h <= 0) return;
+
+    if (job.sdf_spread > 0) {
+        GuiSdf::from_coverage(g->bitmap.buffer, w, h, g->bitmap.pitch, job.sdf_spread,
+                              r.pixels, r.width, r.height);
+        r.pad = job.sdf_spread;
+        r.bearing_x -= job.sdf_spread;
+        r.bearing_y += job.sdf_spread;
+        return;
+    }
+    r.width = w;
+    r.height = h;
+    r.pixels.resize(static_cast<std::size_t>(w) * static_cast<std::size_t>(h));
+    for (int y = 0; y < h; ++y) {
+        std::memcpy(&r.pixels[static_cast<std::size_t>(y) * w],
+                    g->bitmap.buffer + static_cast<std::ptrdiff_t>(y) * g->bitmap.pitch,
+                    static_cast<std::size_t>(w));
+    }
+}
+
+} // namespace
+
+GuiGlyphRasterizer& GuiGlyphRasterizer::instance()
+{
+    static GuiGlyphRasterizer inst;
+    return inst;
+}
+
+GuiGlyphRasterizer::~GuiGlyphRasterizer()
+{
+    shutdown();
+}
+
+void GuiGlyphRasterizer::start()
+{
+    m_started = true;
+    // Leave a core to the GL thread; a few workers are enough to hide a new size
+    const unsigned int hw = std::thread::hardware_concurrency();
+    const unsigned int count = std::max(1u, std::min(4u, hw > 1 ? hw - 1 : 1u));
+    for (unsigned int i = 0; i < count; ++i) {
+        try {
+            m_workers.emplace_back(&GuiGlyphRasterizer::worker_main, this);
+        } catch (const std::system_error&) {
+            break;
+        }
+    }
+    if (m_workers.empty()) {
+        std::fprintf(stderr, "[GuiGlyphRasterizer] No worker thread, glyphs are rasterized synchronously.\n");
+    }
+}
+
+bool GuiGlyphRasterizer::available()
+{
+    if (!m_started) start();
+    return !m_workers.empty() && !m_stop;
+}
+
+void GuiGlyphRasterizer::submit(const Job& job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back(job);
+        ++m_in_flight;
+    }
+    m_cv.notify_one();
+}
+
+std::size_t GuiGlyphRasterizer::take_results(std::vector<Result>& out, std::size_t byte_budget)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::size_t taken = 0, bytes = 0;
+    while (!m_results.empty() && (taken == 0 || bytes < byte_budget)) {
+        bytes += m_results.front().pixels.size();
+        out.push_back(std::move(m_results.front()));
+        m_results.pop_front();
+        ++taken;
+    }
+    m_in_flight -= taken;
+    return taken;
+}
+
+std::size_t GuiGlyphRasterizer::in_flight() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_in_flight;
+}
+
+void GuiGlyphRasterizer::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+        m_in_flight -= m_jobs.size();
+        m_jobs.clear();
+    }
+    m_cv.notify_all();
+    for (std::thread& t : m_workers) {
+        if (t.joinable()) t.join();
+    }
+    m_workers.clear();
+}
+
+void GuiGlyphRasterizer::worker_main()
+{
+    WorkerFonts fonts;
+    for (;;) {
+        Result result;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this] { return m_stop || !m_jobs.empty(); });
+            if (m_stop) return;
+            result.job = m_jobs.front();
+            m_jobs.pop_front();
+        }
+        rasterize(fonts, result);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_results.push_back(std::move(result));
+    }
+}
@@ -0,0 +1,73 @@
+// GuiGlyphRasterizer.h - Background glyph rasterization on worker threads
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "GuiFontRegistry.h"
+
+// Worker pool that renders glyph bitmaps off the GL thread.
+// - Each worker owns an FT_Library and opens its own FT_Face per font on the
+//   registry's memory-mapped file (FreeType objects are never shared).
+// - Finished bitmaps (converted to SDF when asked) wait in a staging queue;
+//   the GL thread drains it with take_results() under a byte budget and
+//   uploads them into the atlases itself.
+// - available() is false when no worker could be started: callers then
+//   rasterize synchronously.
+class GuiGlyphRasterizer {
+public:
+    struct Job {
+        const void* owner = nullptr;   // opaque tag returned with the result
+        FontId font = kInvalidFontId;
+        const unsigned char* file_data = nullptr; // GuiFontRegistry::file_data
+        std::size_t file_size = 0;
+        int pixel_size = 0;
+        unsigned long codepoint = 0;
+        int sdf_spread = 0;            // > 0: distance field padded by this spread
+    };
+
+    struct Result {
+        Job job;
+        bool ok = false;
+        int width = 0;
+        int height = 0;
+        int bearing_x = 0;
+        int bearing_y = 0;
+        unsigned int advance = 0;      // 1/64 pixels
+        int pad = 0;                   // sdf_spread when converted
+        std::vector<unsigned char> pixels; // width * height, tightly packed
+    };
+
+    static GuiGlyphRasterizer& instance();
+
+    bool available();
+    void submit(const Job& job);
+    // Move finished results into `out` until `byte_budget` bitmap bytes are
+    // reached (always at least one when any is ready). Returns the count moved.
+    std::size_t take_results(std::vector<Result>& out, std::size_t byte_budget);
+    std::size_t in_flight() const;   // submitted and not taken yet
+    // Stop and join the workers (queued jobs are dropped)
+    void shutdown();
+
+private:
+    GuiGlyphRasterizer() = default;
+    ~GuiGlyphRasterizer();
+    GuiGlyphRasterizer(const GuiGlyphRasterizer&) = delete;
+    GuiGlyphRasterizer& operator=(const GuiGlyphRasterizer&) = delete;
+
+    void start();
+    void worker_main();
+
+    bool m_started = false;
+    bool m_stop = false;
+    std::vector<std::thread> m_workers;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<Job> m_jobs;
+    std::deque<Result> m_results;
+    std::size_t m_in_flight = 0;
+};
@@ -0,0 +1,169 @@
+// GuiHitTest.cpp - Implementation of GuiHitTest
+
+#include "GuiHitTest.h"
+#include "GuiInput.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Cells per axis are capped: a rect spanning the whole screen is listed in
+// every cell
+constexpr int kMaxCellsPerAxis = 128;
+
+int cell_of(float v, float origin, float inv_cell, int count)
+{
+    const int c = static_cast<int>((v - origin) * inv_cell);
+    return std::max(0, std::min(count - 1, c));
+}
+
+} // namespace
+
+GuiHitTest& GuiHitTest::instance()
+{
+    static GuiHitTest inst;
+    return inst;
+}
+
+void GuiHitTest::add(const GuiElement* element, float x, float y, float w, float h, bool overlay)
+{
+    if (!element || w <= 0.0f || h <= 0.0f) return;
+    Entry e{element, x, y, x + w, y + h, overlay};
+    if (!overlay && !m_clips.empty()) {
+        const Clip& c = m_clips.back();
+        e.x0 = std::max(e.x0, c.x0); e.y0 = std::max(e.y0, c.y0);
+        e.x1 = std::min(e.x1, c.x1); e.y1 = std::min(e.y1, c.y1);
+        if (e.x1 <= e.x0 || e.y1 <= e.y0) return; // clipped out
+    }
+    m_adding.push_back(e);
+}
+
+void GuiHitTest::push_clip(float x, float y, float w, float h, bool intersect)
+{
+    Clip c{x, y, x + w, y + h};
+    if (intersect && !m_clips.empty()) {
+        const Clip& p = m_clips.back();
+        c.x0 = std::max(c.x0, p.x0); c.y0 = std::max(c.y0, p.y0);
+        c.x1 = std::min(c.x1, p.x1); c.y1 = std::min(c.y1, p.y1);
+    }
+    m_clips.push_back(c);
+}
+
+void GuiHitTest::pop_clip()
+{
+    if (!m_clips.empty()) m_clips.pop_back();
+}
+
+bool GuiHitTest::clipped_out(float x, float y, float w, float h) const
+{
+    if (m_clips.empty()) return false;
+    const Clip& c = m_clips.back();
+    return x + w <= c.x0 || x >= c.x1 || y + h <= c.y0 || y >= c.y1;
+}
+
+void GuiHitTest::route(GuiInputState& input)
+{
+    if (!m_forgotten.empty()) {
+        // Drop destroyed elements; the routed set then differs if it held any
+        std::sort(m_forgotten.begin(), m_forgotten.end());
+        auto gone = [this](const Entry& e) { return std::binary_search(m_forgotten.begin(), m_forgotten.end(), e.element); };
+        m_adding.erase(std::remove_if(m_adding.begin(), m_adding.end(), gone), m_adding.end());
+        if (std::any_of(m_entries.begin(), m_entries.end(), gone)) { m_entries.clear(); m_grid_valid = false; }
+        m_forgotten.clear();
+    }
+    // Same rects as the routed set: keep its grid
+    if (m_adding != m_entries) {
+        m_entries.swap(m_adding);
+        m_grid_valid = false;
+        m_scans = 0;
+    }
+    m_adding.clear();
+    m_clips.clear();
+    ++m_frame;
+    input.hover = pick(static_cast<float>(input.mouse_x), static_cast<float>(input.mouse_y));
+}
+
+void GuiHitTest::build_grid()
+{
+    m_grid_valid = true;
+    float x0 = m_entries[0].x0, y0 = m_entries[0].y0, x1 = m_entries[0].x1, y1 = m_entries[0].y1;
+    for (const Entry& e : m_entries) {
+        x0 = std::min(x0, e.x0); y0 = std::min(y0, e.y0);
+        x1 = std::max(x1, e.x1); y1 = std::max(y1, e.y1);
+    }
+    // About one cell per rect, shaped like the covered area
+    const float bw = std::max(1.0f, x1 - x0);
+    const float bh = std::max(1.0f, y1 - y0);
+    const float n = static_cast<float>(m_entries.size());
+    m_cols = std::max(1, std::min(kMaxCellsPerAxis, static_cast<int>(std::lround(std::sqrt(n * bw / bh)))));
+    m_rows = std::max(1, std::min(kMaxCellsPerAxis, static_cast<int>(std::lround(n / static_cast<float>(m_cols)))));
+    m_origin_x = x0;
+    m_origin_y = y0;
+    m_inv_cell_w = static_cast<float>(m_cols) / bw;
+    m_inv_cell_h = static_cast<float>(m_rows) / bh;
+
+    // Counting sort of (cell, entry) pairs; entries go in z-order
+    const std::size_t cells = static_cast<std::size_t>(m_cols) * static_cast<std::size_t>(m_rows);
+    m_cell_start.assign(cells + 1, 0u);
+    for (const Entry& e : m_entries) {
+        const int c0 = cell_of(e.x0, x0, m_inv_cell_w, m_cols), c1 = cell_of(e.x1, x0, m_inv_cell_w, m_cols);
+        const int r0 = cell_of(e.y0, y0, m_inv_cell_h, m_rows), r1 = cell_of(e.y1, y0, m_inv_cell_h, m_rows);
+        for (int r = r0; r <= r1; ++r)
+            for (int c = c0; c <= c1; ++c) ++m_cell_start[static_cast<std::size_t>(r * m_cols + c) + 1];
+    }
+    for (std::size_t c = 0; c < cells; ++c) m_cell_start[c + 1] += m_cell_start[c];
+    m_cell_items.resize(m_cell_start[cells]);
+    m_cell_fill.assign(m_cell_start.begin(), m_cell_start.end() - 1);
+    for (std::size_t i = 0; i < m_entries.size(); ++i) {
+        const Entry& e = m_entries[i];
+        const int c0 = cell_of(e.x0, x0, m_inv_cell_w, m_cols), c1 = cell_of(e.x1, x0, m_inv_cell_w, m_cols);
+        const int r0 = cell_of(e.y0, y0, m_inv_cell_h, m_rows), r1 = cell_of(e.y1, y0, m_inv_cell_h, m_rows);
+        for (int r = r0; r <= r1; ++r)
+            for (int c = c0; c <= c1; ++c)
+                m_cell_items[m_cell_fill[static_cast<std::size_t>(r * m_cols + c)]++] = static_cast<std::uint32_t>(i);
+    }
+}
+
+const GuiElement* GuiHitTest::pick_linear(float x, float y) const
+{
+    const GuiElement* hit = nullptr;
+    for (std::size_t i = m_entries.size(); i-- > 0;) {
+        const Entry& e = m_entries[i];
+        if (!(x >= e.x0 && x <= e.x1 && y >= e.y0 && y <= e.y1)) continue;
+        if (!m_forgotten.empty() && std::find(m_forgotten.begin(), m_forgotten.end(), e.element) != m_forgotten.end()) continue;
+        if (e.overlay) return e.element;
+        if (!hit) hit = e.element;
+    }
+    return hit;
+}
+
+const GuiElement* GuiHitTest::pick(float x, float y)
+{
+    if (m_entries.empty()) return nullptr;
+    if (!m_forgotten.empty()) return pick_linear(x, y); // rare: widgets destroyed since route()
+    if (!m_grid_valid) {
+        if (m_scans++ == 0) return pick_linear(x, y);
+        build_grid();
+    }
+    const float gx = (x - m_origin_x) * m_inv_cell_w;
+    const float gy = (y - m_origin_y) * m_inv_cell_h;
+    if (!(gx >= 0.0f && gy >= 0.0f && gx <= static_cast<float>(m_cols) && gy <= static_cast<float>(m_rows))) return nullptr;
+    const std::size_t cell = static_cast<std::size_t>(cell_of(y, m_origin_y, m_inv_cell_h, m_rows) * m_cols
+                                                      + cell_of(x, m_origin_x, m_inv_cell_w, m_cols));
+    // Topmost first: the first normal hit is the answer unless an overlay
+    // rect below it in the list also contains the point
+    const GuiElement* hit = nullptr;
+    for (std::uint32_t i = m_cell_start[cell + 1]; i-- > m_cell_start[cell];) {
+        const Entry& e = m_entries[m_cell_items[i]];
+        if (!(x >= e.x0 && x <= e.x1 && y >= e.y0 && y <= e.y1)) continue;
+        if (e.overlay) return e.element;
+        if (!hit) hit = e.element;
+    }
+    return hit;
+}
+
+void GuiHitTest::forget(const GuiElement* element)
+{
+    m_forgotten.push_back(element);
+}
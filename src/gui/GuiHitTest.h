@@ -0,0 +1,81 @@
+// GuiHitTest.h - Per-frame spatial index of widget rects for pointer routing
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class GuiElement;
+struct GuiInputState;
+
+// Interactive widgets add their final rect during update(), in update order,
+// which is also draw order: a later rect is on top of an earlier one. Rects
+// are clipped by the clip stack (containers that clip their children push
+// their rect around their children's update). Overlay rects (popups
+// such as menu dropdowns) are above every normal rect and not clipped.
+// route() closes the set of the previous update pass and stores the topmost
+// element under the pointer in GuiInputState::hover, so a click goes to one
+// widget whatever the order of the update pass. Queries use a uniform grid
+// over the set, kept while the rects do not change (retained layout) and
+// otherwise rebuilt on the second query of a frame (one query alone is a
+// linear scan, cheaper than a build). Pointer routing therefore uses the rects of the previous
+// frame (a widget that appears under the pointer reacts from its second frame).
+class GuiHitTest {
+public:
+    static GuiHitTest& instance();
+
+    // Update pass
+    void add(const GuiElement* element, float x, float y, float w, float h, bool overlay = false);
+    // Intersected with the current clip unless `intersect` is false (popups)
+    void push_clip(float x, float y, float w, float h, bool intersect = true);
+    void pop_clip();
+    // Nothing of the rect is inside the current clip (false when none)
+    bool clipped_out(float x, float y, float w, float h) const;
+
+    // Once per frame before the update pass (GuiInput::snapshot() calls it)
+    void route(GuiInputState& input);
+    // Topmost element under (x, y) among the rects of the last routed pass
+    const GuiElement* pick(float x, float y);
+    // `element` is being destroyed: pick() stops returning it and its rects
+    // are dropped at the next route() (batched: teardown of thousands of
+    // widgets stays linear)
+    void forget(const GuiElement* element);
+
+    std::size_t rect_count() const { return m_entries.size(); } // rects of the last routed pass
+    unsigned long frame() const { return m_frame; }             // route() calls so far
+
+private:
+    GuiHitTest() = default;
+    GuiHitTest(const GuiHitTest&) = delete;
+    GuiHitTest& operator=(const GuiHitTest&) = delete;
+
+    struct Entry {
+        const GuiElement* element;
+        float x0, y0, x1, y1;
+        bool overlay;
+        bool operator==(const Entry& o) const {
+            return element == o.element && x0 == o.x0 && y0 == o.y0 && x1 == o.x1 && y1 == o.y1 && overlay == o.overlay;
+        }
+    };
+    struct Clip { float x0, y0, x1, y1; };
+
+    void build_grid();
+    const GuiElement* pick_linear(float x, float y) const;
+
+    std::vector<Entry> m_adding;   // rects of the update pass in progress
+    std::vector<Entry> m_entries;  // rects of the last routed pass, in z-order
+    std::vector<Clip> m_clips;
+    std::vector<const GuiElement*> m_forgotten; // destroyed since the last route()
+    unsigned long m_frame = 0;
+
+    // Uniform grid over m_entries: cell c lists entry indices
+    // m_cell_items[m_cell_start[c] .. m_cell_start[c + 1]), in z-order
+    bool m_grid_valid = false;
+    int m_scans = 0; // linear picks since the set changed
+    float m_origin_x = 0.0f, m_origin_y = 0.0f;
+    float m_inv_cell_w = 0.0f, m_inv_cell_h = 0.0f;
+    int m_cols = 0, m_rows = 0;
+    std::vector<std::uint32_t> m_cell_start;
+    std::vector<std::uint32_t> m_cell_items;
+    std::vector<std::uint32_t> m_cell_fill; // build scratch
+};
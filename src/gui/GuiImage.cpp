@@ -2,6 +2,7 @@
 
 #include "GuiImage.h"
 #include "GuiDraw.h"
+#include "GuiGlState.h"
 
 #include <cstdio>
 #include <vector>
@@ -12,11 +13,12 @@
 
 GuiImage::GuiImage() {}
 GuiImage::~GuiImage() {
-    if (m_tex) glDeleteTextures(1, &m_tex);
+    if (m_tex) { GuiGlState::forget_texture(m_tex); glDeleteTextures(1, &m_tex); }
 }
 
 bool GuiImage::set_texture(const std::string& texture_path)
 {
+    mark_layout_dirty(); // preferred size is the texture size
     // Try simple PPM (P6) first
     if (load_ppm(texture_path)) return true;
     std::fprintf(stderr, "[GuiImage] Failed to load '%s'. Using placeholder.\n", texture_path.c_str());
@@ -30,31 +32,29 @@ std::pair<float,float> GuiImage::preferred_size() const
     return {static_cast<float>(m_tex_w), static_cast<float>(m_tex_h)};
 }
 
-void GuiImage::draw()
+void GuiImage::update(float /*dt*/, GuiInputState& /*input*/)
 {
     if (!m_visible) return;
     if (m_tex == 0) create_placeholder();
-    if (m_tex == 0) return;
 
     float x = pixel_x();
     float y = pixel_y();
-    float w = pixel_w();
-    float h = pixel_h();
+    float w = box_w();
+    float h = box_h();
     if (w <= 0.0f || h <= 0.0f) {
         auto ps = preferred_size();
         if (w <= 0.0f) w = ps.first;
         if (h <= 0.0f) h = ps.second;
     }
-    if (w <= 0.0f || h <= 0.0f) return;
-
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    GLboolean depthWasEnabled = glIsEnabled(GL_DEPTH_TEST);
-    if (depthWasEnabled) glDisable(GL_DEPTH_TEST);
-
-    GuiDraw::draw_textured_quad(x, y, w, h, m_tex);
+    m_rect = DrawRect{x, y, w, h, m_tex != 0 && w > 0.0f && h > 0.0f};
+    if (m_rect.valid && culled(x, y, w, h)) m_rect.valid = false;
+    if (m_rect.valid) add_hit_rect(x, y, w, h); // covers what is below it
+}
 
-    if (depthWasEnabled) glEnable(GL_DEPTH_TEST);
+void GuiImage::draw() const
+{
+    if (!m_visible || !m_rect.valid) return;
+    GuiDraw::draw_textured_quad(m_rect.x, m_rect.y, m_rect.w, m_rect.h, m_tex);
 }
 
 bool GuiImage::load_ppm(const std::string& path)
@@ -86,16 +86,15 @@ bool GuiImage::load_ppm(const std::string& path)
         f.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(size));
         if (static_cast<size_t>(f.gcount()) != size) return false;
 
-        if (m_tex) { glDeleteTextures(1, &m_tex); m_tex = 0; }
+        if (m_tex) { GuiGlState::forget_texture(m_tex); glDeleteTextures(1, &m_tex); m_tex = 0; }
         glGenTextures(1, &m_tex);
-        glBindTexture(GL_TEXTURE_2D, m_tex);
+        GuiGlState::bind_texture_2d(0, m_tex);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, w, h, 0, GL_RGB, GL_UNSIGNED_BYTE, data.data());
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glBindTexture(GL_TEXTURE_2D, 0);
-
+    
         m_tex_w = w; m_tex_h = h;
         return true;
     } else {
@@ -110,15 +109,14 @@ bool GuiImage::load_ppm(const std::string& path)
         }
         if (static_cast<int>(data.size()) != w*h*3) return false;
 
-    if (m_tex) { glDeleteTextures(1, &m_tex); m_tex = 0; }
+    if (m_tex) { GuiGlState::forget_texture(m_tex); glDeleteTextures(1, &m_tex); m_tex = 0; }
     glGenTextures(1, &m_tex);
-    glBindTexture(GL_TEXTURE_2D, m_tex);
+    GuiGlState::bind_texture_2d(0, m_tex);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, w, h, 0, GL_RGB, GL_UNSIGNED_BYTE, data.data());
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glBindTexture(GL_TEXTURE_2D, 0);
 
     m_tex_w = w; m_tex_h = h;
     return true;
@@ -132,14 +130,13 @@ void GuiImage::create_placeholder()
         200,200,210,255,  80,80,100,255,
          80,80,100,255, 200,200,210,255,
     };
-    if (m_tex) glDeleteTextures(1, &m_tex);
+    if (m_tex) { GuiGlState::forget_texture(m_tex); glDeleteTextures(1, &m_tex); }
     glGenTextures(1, &m_tex);
-    glBindTexture(GL_TEXTURE_2D, m_tex);
+    GuiGlState::bind_texture_2d(0, m_tex);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 2, 2, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glBindTexture(GL_TEXTURE_2D, 0);
     m_tex_w = 64; m_tex_h = 64; // nominal preferred size
 }
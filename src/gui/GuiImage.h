@@ -15,7 +15,8 @@ public:
     void set_size(float width, float height) { GuiElement::set_size(width, height, false); }
     void set_position(float x, float y) { GuiElement::set_position(x, y, false); }
 
-    void draw() override;
+    void update(float dt, GuiInputState& input) override;
+    void draw() const override;
     std::pair<float,float> preferred_size() const override;
 
 private:
@@ -2,6 +2,7 @@
 
 #include "GuiInput.h"
 #include "GuiButton.h" // chain callbacks for backward compatibility
+#include "GuiHitTest.h"
 
 #include <GLFW/glfw3.h>
 
@@ -9,6 +10,7 @@ double GuiInput::s_mouse_x_px = 0.0;
 double GuiInput::s_mouse_y_px = 0.0;
 bool   GuiInput::s_left_down = false;
 bool   GuiInput::s_left_clicked = false;
+double GuiInput::s_scroll_y = 0.0;
 std::array<bool, 512> GuiInput::s_key_down{};
 std::array<bool, 512> GuiInput::s_key_pressed{};
 std::vector<unsigned int> GuiInput::s_chars;
@@ -16,6 +18,7 @@ std::vector<unsigned int> GuiInput::s_chars;
 void GuiInput::begin_frame()
 {
     s_left_clicked = false;
+    s_scroll_y = 0.0;
     s_chars.clear();
     s_key_pressed.fill(false);
 }
@@ -80,6 +83,11 @@ void GuiInput::glfw_char_callback(GLFWwindow* /*window*/, unsigned int codepoint
     s_chars.push_back(codepoint);
 }
 
+void GuiInput::glfw_scroll_callback(GLFWwindow* /*window*/, double /*xoffset*/, double yoffset)
+{
+    s_scroll_y += yoffset;
+}
+
 std::pair<double,double> GuiInput::mouse_pos_px()
 {
     return {s_mouse_x_px, s_mouse_y_px};
@@ -87,6 +95,7 @@ std::pair<double,double> GuiInput::mouse_pos_px()
 
 bool GuiInput::left_down() { return s_left_down; }
 bool GuiInput::left_clicked() { return s_left_clicked; }
+double GuiInput::scroll_y() { return s_scroll_y; }
 
 bool GuiInput::key_down(int key)
 {
@@ -109,3 +118,18 @@ std::vector<unsigned int> GuiInput::consume_chars()
     return out;
 }
 
+GuiInputState GuiInput::snapshot()
+{
+    GuiInputState in;
+    in.mouse_x = s_mouse_x_px;
+    in.mouse_y = s_mouse_y_px;
+    in.left_down = s_left_down;
+    in.left_clicked = s_left_clicked;
+    in.scroll_y = s_scroll_y;
+    in.keys_down = s_key_down;
+    in.keys_pressed = s_key_pressed;
+    in.chars = consume_chars();
+    GuiHitTest::instance().route(in);
+    return in;
+}
+
@@ -3,10 +3,38 @@
 
 #include <vector>
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <utility>
 
 struct GLFWwindow;
+class GuiElement;
+
+// One frame of input, taken once by the application and handed down the GUI
+// tree by update(dt, input). Widgets read it instead of the GuiInput globals,
+// so GUI logic does not depend on when the GLFW callbacks run.
+struct GuiInputState {
+    double mouse_x = 0.0;        // framebuffer pixels, origin bottom-left
+    double mouse_y = 0.0;
+    bool   left_down = false;
+    bool   left_clicked = false; // one-shot for this frame, seen by every widget
+    double scroll_y = 0.0;       // wheel steps this frame (+ = away from the user)
+    std::array<bool, 512> keys_down{};
+    std::array<bool, 512> keys_pressed{};
+    std::vector<unsigned int> chars; // typed codepoints; a focused field takes them
+    // Topmost widget under the pointer (GuiHitTest::route); widgets react to
+    // the pointer only when they are the hover element
+    const GuiElement* hover = nullptr;
+
+    bool key_down(int key) const { return key >= 0 && key < 512 && keys_down[static_cast<std::size_t>(key)]; }
+    bool key_pressed(int key) const { return key >= 0 && key < 512 && keys_pressed[static_cast<std::size_t>(key)]; }
+    // Buttons: the first one under this frame's click fires it; later calls
+    // return false (left_clicked itself stays set for focus/close logic)
+    bool claim_click() { if (!left_clicked || m_click_claimed) return false; m_click_claimed = true; return true; }
+
+private:
+    bool m_click_claimed = false;
+};
 
 class GuiInput {
 public:
@@ -18,11 +46,13 @@ public:
     static void glfw_mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
     static void glfw_key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
     static void glfw_char_callback(GLFWwindow* window, unsigned int codepoint);
+    static void glfw_scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 
     // Mouse state (in framebuffer pixels, origin bottom-left)
     static std::pair<double,double> mouse_pos_px();
     static bool left_down();
     static bool left_clicked(); // one-shot for the current frame
+    static double scroll_y();   // wheel steps this frame (+ = away from the user)
 
     // Keyboard
     static bool key_down(int key);      // held state
@@ -31,11 +61,17 @@ public:
     // Text input (UTF-32 codepoints) accumulated this frame; consuming clears the buffer
     static std::vector<unsigned int> consume_chars();
 
+    // This frame's input for update(dt, input); call after glfwPollEvents.
+    // Takes the typed characters (as consume_chars) and routes the pointer
+    // (GuiHitTest::route).
+    static GuiInputState snapshot();
+
 private:
     static double s_mouse_x_px;
     static double s_mouse_y_px;
     static bool   s_left_down;
     static bool   s_left_clicked;
+    static double s_scroll_y;
 
     static std::array<bool, 512> s_key_down;
     static std::array<bool, 512> s_key_pressed;
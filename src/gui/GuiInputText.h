@@ -28,21 +28,21 @@ public:
                     float text_r, float text_g, float text_b, float text_a,
                     float placeholder_r, float placeholder_g, float placeholder_b, float placeholder_a);
     void set_corner_radius(float r) { m_radius = (r < 0.f ? 0.f : r); }
-    void set_padding(float px, float py) { m_pad_x = (px < 0 ? 0.f : px); m_pad_y = (py < 0 ? 0.f : py); }
-    void set_text_size(int sz_1_to_10) { m_label.set_text_size(sz_1_to_10); }
-    bool set_text_font(const std::string& path) { return m_label.set_text_font(path); }
+    void set_padding(float px, float py) { m_pad_x = (px < 0 ? 0.f : px); m_pad_y = (py < 0 ? 0.f : py); mark_layout_dirty(); }
+    void set_text_size(int sz_1_to_10) { m_label.set_text_size(sz_1_to_10); mark_layout_dirty(); }
+    bool set_text_font(const std::string& path) { mark_layout_dirty(); return m_label.set_text_font(path); }
 
-    void draw() override;
+    void update(float dt, GuiInputState& input) override;
+    void draw() const override;
     std::pair<float,float> preferred_size() const override;
 
 private:
-    bool hit_test(float px, float py, float x, float y, float w, float h) const;
-
-private:
-    mutable GuiText m_label;
+    GuiText m_label;
     std::string m_text;
     std::string m_placeholder;
     bool m_focused = false;
+    float m_caret_time = 0.0f;  // seconds since focus or the last edit (blink phase)
+    float m_caret[4] = {0.f, 0.f, 0.f, 0.f}; // caret rect set by update()
     float m_pad_x = 8.0f;
     float m_pad_y = 6.0f;
     float m_radius = 4.0f;
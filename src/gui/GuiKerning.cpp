@@ -0,0 +1,247 @@
+// GuiKerning.cpp - Implementation of the kerning pair table
+
+#include "GuiKerning.h"
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_TRUETYPE_TABLES_H
+#include FT_TRUETYPE_TAGS_H
+
+#include <cstdio>
+
+namespace {
+
+constexpr std::size_t kMaxPairs = 1u << 20; // class expansion guard
+
+// Big-endian reads with bounds checks (out of range reads return 0 and clear ok)
+struct Reader {
+    const unsigned char* data;
+    std::size_t size;
+    bool ok = true;
+
+    std::uint16_t u16(std::size_t o)
+    {
+        if (o + 2 > size) { ok = false; return 0; }
+        return static_cast<std::uint16_t>((data[o] << 8) | data[o + 1]);
+    }
+    std::int16_t s16(std::size_t o) { return static_cast<std::int16_t>(u16(o)); }
+    std::uint32_t u32(std::size_t o)
+    {
+        return (static_cast<std::uint32_t>(u16(o)) << 16) | u16(o + 2);
+    }
+};
+
+static int popcount16(unsigned v)
+{
+    int n = 0;
+    for (; v; v &= v - 1) ++n;
+    return n;
+}
+
+// Coverage table -> glyphs in coverage index order
+static std::vector<std::uint16_t> read_coverage(Reader& r, std::size_t o)
+{
+    std::vector<std::uint16_t> glyphs;
+    const std::uint16_t format = r.u16(o);
+    const std::uint16_t count = r.u16(o + 2);
+    if (format == 1) {
+        for (std::uint16_t i = 0; i < count && r.ok; ++i) glyphs.push_back(r.u16(o + 4 + 2u * i));
+    } else if (format == 2) {
+        for (std::uint16_t i = 0; i < count && r.ok; ++i) {
+            const std::size_t rec = o + 4 + 6u * i;
+            const std::uint16_t first = r.u16(rec), last = r.u16(rec + 2);
+            for (std::uint32_t g = first; g <= last && r.ok; ++g) glyphs.push_back(static_cast<std::uint16_t>(g));
+        }
+    }
+    return glyphs;
+}
+
+// ClassDef table -> (glyph, class) for every glyph with a non-zero class
+static std::vector<std::pair<std::uint16_t, std::uint16_t>> read_class_def(Reader& r, std::size_t o)
+{
+    std::vector<std::pair<std::uint16_t, std::uint16_t>> out;
+    const std::uint16_t format = r.u16(o);
+    if (format == 1) {
+        const std::uint16_t start = r.u16(o + 2), count = r.u16(o + 4);
+        for (std::uint16_t i = 0; i < count && r.ok; ++i) {
+            const std::uint16_t cls = r.u16(o + 6 + 2u * i);
+            if (cls) out.emplace_back(static_cast<std::uint16_t>(start + i), cls);
+        }
+    } else if (format == 2) {
+        const std::uint16_t count = r.u16(o + 2);
+        for (std::uint16_t i = 0; i < count && r.ok; ++i) {
+            const std::size_t rec = o + 4 + 6u * i;
+            const std::uint16_t first = r.u16(rec), last = r.u16(rec + 2), cls = r.u16(rec + 4);
+            for (std::uint32_t g = first; g <= last && cls && r.ok; ++g) out.emplace_back(static_cast<std::uint16_t>(g), cls);
+        }
+    }
+    return out;
+}
+
+// One PairPos subtable; pairs already set by an earlier subtable of the same lookup win
+static void read_pair_pos(Reader& r, std::size_t o, std::unordered_map<std::uint32_t, std::int16_t>& lookup_pairs)
+{
+    const std::uint16_t format = r.u16(o);
+    const std::vector<std::uint16_t> coverage = read_coverage(r, o + r.u16(o + 2));
+    const std::uint16_t vf1 = r.u16(o + 4), vf2 = r.u16(o + 6);
+    if (!(vf1 & 0x0004)) return; // no XAdvance on the first glyph
+    const std::size_t size1 = 2u * popcount16(vf1), size2 = 2u * popcount16(vf2);
+    const std::size_t x_advance = 2u * popcount16(vf1 & 0x0003); // after XPlacement/YPlacement
+
+    if (format == 1) {
+        const std::uint16_t set_count = r.u16(o + 8);
+        for (std::uint16_t i = 0; i < set_count && i < coverage.size() && r.ok; ++i) {
+            const std::size_t set = o + r.u16(o + 10 + 2u * i);
+            const std::uint16_t count = r.u16(set);
+            for (std::uint16_t k = 0; k < count && r.ok; ++k) {
+                const std::size_t rec = set + 2 + k * (2 + size1 + size2);
+                const std::int16_t value = r.s16(rec + 2 + x_advance);
+                if (value) lookup_pairs.emplace((static_cast<std::uint32_t>(coverage[i]) << 16) | r.u16(rec), value);
+            }
+        }
+    } else if (format == 2) {
+        const auto class1 = read_class_def(r, o + r.u16(o + 8));
+        const auto class2 = read_class_def(r, o + r.u16(o + 10));
+        const std::uint16_t class1_count = r.u16(o + 12), class2_count = r.u16(o + 14);
+        std::unordered_map<std::uint16_t, std::uint16_t> class1_of(class1.begin(), class1.end());
+        std::vector<std::vector<std::uint16_t>> glyphs_of_class2(class2_count);
+        for (const auto& gc : class2) {
+            if (gc.second < class2_count) glyphs_of_class2[gc.second].push_back(gc.first);
+        }
+        const std::size_t rec_size = size1 + size2;
+        for (std::uint16_t left : coverage) {
+            auto it = class1_of.find(left);
+            const std::uint16_t c1 = (it == class1_of.end()) ? 0 : it->second;
+            if (c1 >= class1_count) continue;
+            for (std::uint16_t c2 = 1; c2 < class2_count && r.ok; ++c2) {
+                const std::int16_t value = r.s16(o + 16 + (static_cast<std::size_t>(c1) * class2_count + c2) * rec_size + x_advance);
+                if (!value) continue;
+                for (std::uint16_t right : glyphs_of_class2[c2]) {
+                    lookup_pairs.emplace((static_cast<std::uint32_t>(left) << 16) | right, value);
+                }
+                if (lookup_pairs.size() > kMaxPairs) return;
+            }
+        }
+    }
+}
+
+static bool load_table(FT_Face face, FT_ULong tag, std::vector<unsigned char>& out)
+{
+    FT_ULong length = 0;
+    if (FT_Load_Sfnt_Table(face, tag, 0, nullptr, &length) != 0 || length == 0) return false;
+    out.resize(length);
+    return FT_Load_Sfnt_Table(face, tag, 0, out.data(), &length) == 0;
+}
+
+} // namespace
+
+bool GuiKerning::load(void* ft_face)
+{
+    FT_Face face = reinterpret_cast<FT_Face>(ft_face);
+    m_pairs.clear();
+    m_units_per_em = face ? face->units_per_EM : 0;
+    if (!face || !FT_IS_SFNT(face) || m_units_per_em <= 0) return false;
+
+    // GPOS kerning first (what shapers use), legacy table otherwise
+    std::vector<unsigned char> table;
+    if (load_table(face, TTAG_GPOS, table) && load_gpos(table) && !m_pairs.empty()) return true;
+    m_pairs.clear();
+    if (load_table(face, TTAG_kern, table)) load_kern(table);
+    return !m_pairs.empty();
+}
+
+bool GuiKerning::load_gpos(const std::vector<unsigned char>& gpos)
+{
+    Reader r{gpos.data(), gpos.size()};
+    const std::size_t feature_list = r.u16(4 + 2);
+    const std::size_t lookup_list = r.u16(4 + 4);
+    if (!r.ok || feature_list == 0 || lookup_list == 0) return false;
+
+    // Lookups of every 'kern' feature (all scripts and languages)
+    std::vector<std::uint16_t> lookups;
+    const std::uint16_t feature_count = r.u16(feature_list);
+    for (std::uint16_t i = 0; i < feature_count && r.ok; ++i) {
+        const std::size_t rec = feature_list + 2 + 6u * i;
+        if (rec + 4 > gpos.size() || gpos[rec] != 'k' || gpos[rec + 1] != 'e' || gpos[rec + 2] != 'r' || gpos[rec + 3] != 'n') continue;
+        const std::size_t feature = feature_list + r.u16(rec + 4);
+        const std::uint16_t count = r.u16(feature + 2);
+        for (std::uint16_t k = 0; k < count && r.ok; ++k) {
+            const std::uint16_t index = r.u16(feature + 4 + 2u * k);
+            bool seen = false;
+            for (std::uint16_t l : lookups) seen = seen || (l == index);
+            if (!seen) lookups.push_back(index);
+        }
+    }
+
+    // Lookups apply one after the other: their adjustments add up
+    const std::uint16_t lookup_count = r.u16(lookup_list);
+    for (std::uint16_t index : lookups) {
+        if (index >= lookup_count) continue;
+        const std::size_t lookup = lookup_list + r.u16(lookup_list + 2 + 2u * index);
+        const std::uint16_t type = r.u16(lookup);
+        const std::uint16_t sub_count = r.u16(lookup + 4);
+        std::unordered_map<std::uint32_t, std::int16_t> lookup_pairs;
+        for (std::uint16_t s = 0; s < sub_count && r.ok; ++s) {
+            std::size_t sub = lookup + r.u16(lookup + 6 + 2u * s);
+            std::uint16_t sub_type = type;
+            if (type == 9) { // extension: real type and 32-bit offset
+                sub_type = r.u16(sub + 2);
+                sub += r.u32(sub + 4);
+            }
+            if (sub_type == 2) read_pair_pos(r, sub, lookup_pairs);
+        }
+        for (const auto& kv : lookup_pairs) {
+            const int sum = m_pairs[kv.first] + kv.second;
+            m_pairs[kv.first] = static_cast<std::int16_t>(sum);
+        }
+        if (m_pairs.size() > kMaxPairs) {
+            std::fprintf(stderr, "[GuiKerning] Too many kerning pairs, table truncated.\n");
+            break;
+        }
+    }
+    return r.ok;
+}
+
+bool GuiKerning::load_kern(const std::vector<unsigned char>& kern)
+{
+    Reader r{kern.data(), kern.size()};
+    if (r.u16(0) != 0) return false; // Apple 'kern' (version 1.0) not supported
+    const std::uint16_t table_count = r.u16(2);
+    std::size_t sub = 4;
+    for (std::uint16_t t = 0; t < table_count && r.ok; ++t) {
+        const std::uint16_t length = r.u16(sub + 2);
+        const std::uint16_t coverage = r.u16(sub + 4);
+        // Format 0, horizontal, kerning values (not minimum, not cross-stream)
+        if ((coverage >> 8) == 0 && (coverage & 0x7) == 0x1) {
+            const std::uint16_t count = r.u16(sub + 6);
+            const bool replace = (coverage & 0x8) != 0;
+            for (std::uint16_t k = 0; k < count && r.ok; ++k) {
+                const std::size_t rec = sub + 14 + 6u * k;
+                const std::uint32_t key = (static_cast<std::uint32_t>(r.u16(rec)) << 16) | r.u16(rec + 2);
+                const std::int16_t value = r.s16(rec + 4);
+                m_pairs[key] = replace ? value : static_cast<std::int16_t>(m_pairs[key] + value);
+            }
+        }
+        if (length < 6) break;
+        sub += length;
+    }
+    return r.ok;
+}
+
+void GuiKerning::set_pairs(const std::vector<Pair>& pairs, int units_per_em)
+{
+    m_units_per_em = units_per_em;
+    m_pairs.clear();
+    m_pairs.reserve(pairs.size());
+    for (const Pair& p : pairs) m_pairs[(static_cast<std::uint32_t>(p.left) << 16) | p.right] = p.value;
+}
+
+std::vector<GuiKerning::Pair> GuiKerning::pairs() const
+{
+    std::vector<Pair> out;
+    out.reserve(m_pairs.size());
+    for (const auto& kv : m_pairs) {
+        out.push_back(Pair{static_cast<std::uint16_t>(kv.first >> 16), static_cast<std::uint16_t>(kv.first & 0xFFFFu), kv.second});
+    }
+    return out;
+}
@@ -0,0 +1,48 @@
+// GuiKerning.h - Kerning pair table of a font (GPOS pair positioning or legacy 'kern')
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Horizontal kerning of glyph pairs, in font units (size independent: one
+// table per font file, scaled by pixel_size / units_per_em at layout).
+// load() reads the raw sfnt tables once instead of calling FT_Get_Kerning
+// per pair:
+// - GPOS: PairPos lookups (formats 1 and 2, extension lookups included)
+//   referenced by any 'kern' feature; class pairs are expanded to glyph
+//   pairs, class 0 of the second glyph excepted.
+// - Otherwise the legacy 'kern' table (format 0 horizontal subtables).
+class GuiKerning {
+public:
+    struct Pair {
+        std::uint16_t left;   // glyph indices
+        std::uint16_t right;
+        std::int16_t value;   // x advance adjustment, font units
+    };
+
+    // Parse the tables of an FT_Face (void* keeps FreeType headers out)
+    bool load(void* ft_face);
+    // Install pairs read from a baked atlas file
+    void set_pairs(const std::vector<Pair>& pairs, int units_per_em);
+
+    bool empty() const { return m_pairs.empty(); }
+    int units_per_em() const { return m_units_per_em; }
+    std::size_t size() const { return m_pairs.size(); }
+    std::vector<Pair> pairs() const;
+
+    // Adjustment for `left` followed by `right`, in font units (0 if none)
+    int adjust(std::uint32_t left, std::uint32_t right) const
+    {
+        if (m_pairs.empty()) return 0;
+        auto it = m_pairs.find((left << 16) | (right & 0xFFFFu));
+        return it == m_pairs.end() ? 0 : it->second;
+    }
+
+private:
+    bool load_gpos(const std::vector<unsigned char>& gpos);
+    bool load_kern(const std::vector<unsigned char>& kern);
+
+    int m_units_per_em = 0;
+    std::unordered_map<std::uint32_t, std::int16_t> m_pairs; // (left << 16) | right
+};
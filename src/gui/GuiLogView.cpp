@@ -0,0 +1,179 @@
+// GuiLogView.cpp - Implementation of GuiLogView
+
+#include "GuiLogView.h"
+#include "GuiDraw.h"
+#include "GuiInput.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+
+GuiLogView::GuiLogView(std::size_t capacity)
+    : m_lines(capacity > 0 ? capacity : 1)
+{
+}
+
+void GuiLogView::append(std::string line)
+{
+    m_queue.push(std::move(line));
+}
+
+void GuiLogView::appendf(const char* fmt, ...)
+{
+    char buf[1024];
+    va_list args;
+    va_start(args, fmt);
+    std::vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    m_queue.push(std::string(buf));
+}
+
+void GuiLogView::clear()
+{
+    drain(); // queued lines predate the clear
+    for (std::string& s : m_lines) std::string().swap(s);
+    m_count = 0;
+    m_scroll = 0;
+    for (auto& row : m_rows) row->seq = ~0ull;
+    m_shown = 0;
+}
+
+void GuiLogView::drain()
+{
+    // At most one ring's worth per frame: more would only overwrite itself
+    std::string line;
+    std::size_t added = 0;
+    const std::size_t cap = m_lines.size();
+    while (added < cap && m_queue.pop(line)) {
+        m_lines[static_cast<std::size_t>(m_next_seq % cap)].swap(line);
+        ++m_next_seq;
+        ++added;
+    }
+    if (added == 0) return;
+    m_count = std::min(cap, m_count + added);
+    // Scrolled back: keep the same lines on screen
+    if (m_scroll > 0) m_scroll = std::min(m_scroll + added, m_count > 0 ? m_count - 1 : 0);
+}
+
+void GuiLogView::scroll_lines(int delta)
+{
+    const long long target = static_cast<long long>(m_scroll) + delta;
+    const long long max_scroll = m_count > 0 ? static_cast<long long>(m_count) - 1 : 0;
+    m_scroll = static_cast<std::size_t>(std::max(0LL, std::min(target, max_scroll)));
+}
+
+bool GuiLogView::set_text_font(const std::string& path)
+{
+    m_font_path = path;
+    bool ok = true;
+    for (auto& row : m_rows) ok = row->text.set_text_font(path) && ok;
+    return ok && !path.empty();
+}
+
+void GuiLogView::set_text_size(int size_1_to_10)
+{
+    m_text_size = size_1_to_10;
+    mark_layout_dirty();
+    for (auto& row : m_rows) row->text.set_text_size(size_1_to_10);
+}
+
+void GuiLogView::set_text_color(float r, float g, float b, float a)
+{
+    m_text_color[0]=r; m_text_color[1]=g; m_text_color[2]=b; m_text_color[3]=a;
+    for (auto& row : m_rows) row->text.set_text_color(r, g, b, a);
+}
+
+void GuiLogView::set_background_color(float r, float g, float b, float a)
+{
+    m_bg[0]=r; m_bg[1]=g; m_bg[2]=b; m_bg[3]=a;
+}
+
+void GuiLogView::reset_rows(std::size_t count)
+{
+    m_rows.clear();
+    m_rows.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        std::unique_ptr<Row> row(new Row());
+        if (!m_font_path.empty()) row->text.set_text_font(m_font_path);
+        row->text.set_text_size(m_text_size);
+        row->text.set_text_color(m_text_color[0], m_text_color[1], m_text_color[2], m_text_color[3]);
+        m_rows.push_back(std::move(row));
+    }
+}
+
+float GuiLogView::line_height() const
+{
+    // Pixel size of the text plus 20% leading
+    return std::round(static_cast<float>(GuiText::pixel_size(m_text_size)) * 1.2f);
+}
+
+std::pair<float,float> GuiLogView::preferred_size() const
+{
+    if (m_size_w > 0.0f && m_size_h > 0.0f) return {pixel_w(), pixel_h()};
+    return {480.0f, 10.0f * line_height() + 2.0f * m_padding};
+}
+
+void GuiLogView::update(float dt, GuiInputState& input)
+{
+    // Hidden too: queued lines must reach the ring or the queue grows unbounded
+    drain();
+    if (!m_visible) return;
+
+    float w = box_w();
+    float h = box_h();
+    if (w <= 0.0f || h <= 0.0f) {
+        auto ps = preferred_size();
+        if (w <= 0.0f) w = ps.first;
+        if (h <= 0.0f) h = ps.second;
+    }
+    m_shown = 0;
+    m_rect.valid = w > 0.0f && h > 0.0f;
+    if (!m_rect.valid) return;
+    float x = 0.0f, y = 0.0f;
+    compute_aligned_xy(w, h, x, y);
+    m_rect = DrawRect{x, y, w, h, true};
+    if (culled(x, y, w, h)) { m_rect.valid = false; return; }
+
+    add_hit_rect(x, y, w, h);
+    const bool hovered = input.hover == this;
+    if (hovered && input.scroll_y != 0.0) scroll_lines(static_cast<int>(std::lround(input.scroll_y * 3.0)));
+
+    // One row per visible line, plus one so that scrolling by a line reuses
+    // every other row (line seq maps to row seq % rows)
+    const float lh = line_height();
+    const std::size_t visible = lh > 0.0f ? static_cast<std::size_t>(std::max(0.0f, (h - 2.0f * m_padding) / lh)) : 0;
+    if (m_rows.size() != visible + 1) reset_rows(visible + 1);
+    if (visible == 0 || m_count == 0) return;
+
+    // Newest shown line at the bottom, older ones above
+    const std::uint64_t newest = m_next_seq - 1 - m_scroll;
+    const std::uint64_t oldest = m_next_seq - m_count;
+    const std::size_t cap = m_lines.size();
+    m_shown_newest = newest;
+    for (std::size_t i = 0; i < visible; ++i) {
+        if (newest < oldest + i) break;
+        const std::uint64_t seq = newest - i;
+        Row& row = *m_rows[static_cast<std::size_t>(seq % m_rows.size())];
+        if (row.seq != seq) {
+            row.seq = seq;
+            row.text.set_text(m_lines[static_cast<std::size_t>(seq % cap)]);
+        }
+        row.text.set_position(x + m_padding, y + m_padding + static_cast<float>(i) * lh, false);
+        row.text.update(dt, input);
+        ++m_shown;
+    }
+}
+
+void GuiLogView::draw() const
+{
+    if (!m_visible || !m_rect.valid) return;
+    if (m_bg[3] > 0.0f) GuiDraw::draw_rect(m_rect.x, m_rect.y, m_rect.w, m_rect.h, m_bg);
+    // Lines wider than the view are cut at its edge
+    GuiDraw::push_clip(m_rect.x, m_rect.y, m_rect.w, m_rect.h);
+    for (std::size_t i = 0; i < m_shown; ++i) {
+        const std::uint64_t seq = m_shown_newest - i;
+        m_rows[static_cast<std::size_t>(seq % m_rows.size())]->text.draw();
+    }
+    GuiDraw::pop_clip();
+}
@@ -0,0 +1,71 @@
+// GuiLogView.h - In-game console: ring buffer of text lines, appendable from any thread
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "GuiElement.h"
+#include "GuiText.h"
+#include "GuiMpscQueue.h"
+
+// Scrolling log of single-line entries, newest at the bottom.
+// - append()/appendf() may be called from any thread: lines go through a
+//   lock-free MPSC queue and are moved into the ring by update() (GUI thread),
+//   also while the view is hidden.
+// - The ring holds `capacity` lines; the oldest are overwritten.
+// - Only the visible lines are drawn. Each row keeps its GuiText (and so its
+//   cached glyph run) while the same line stays on screen: scrolling by one
+//   line lays out one line.
+// - Mouse wheel over the view scrolls; at the bottom, new lines follow.
+class GuiLogView : public GuiElement {
+public:
+    explicit GuiLogView(std::size_t capacity = 100000);
+
+    // Any thread
+    void append(std::string line);
+    void appendf(const char* fmt, ...); // printf-style, truncated to 1 KB
+
+    // GUI thread
+    void clear();
+    std::size_t size() const { return m_count; }          // lines held (queued ones excluded)
+    std::size_t capacity() const { return m_lines.size(); }
+    void scroll_lines(int delta);                          // > 0 = towards older lines
+    void scroll_to_bottom() { m_scroll = 0; }
+    bool following() const { return m_scroll == 0; }
+
+    bool set_text_font(const std::string& path);
+    void set_text_size(int size_1_to_10);
+    void set_text_color(float r, float g, float b, float a);
+    void set_background_color(float r, float g, float b, float a);
+    void set_padding(float p) { m_padding = (p < 0.f ? 0.f : p); mark_layout_dirty(); }
+
+    void update(float dt, GuiInputState& input) override;
+    void draw() const override;
+    std::pair<float,float> preferred_size() const override;
+
+private:
+    struct Row {
+        std::uint64_t seq = ~0ull; // line shown by this row
+        GuiText text;
+    };
+
+    void drain();
+    void reset_rows(std::size_t count);
+    float line_height() const;
+
+    std::vector<std::string> m_lines;   // ring, line `seq` at seq % capacity
+    std::uint64_t m_next_seq = 0;       // seq of the next line
+    std::size_t m_count = 0;
+    std::size_t m_scroll = 0;           // newest lines hidden below the view
+    GuiMpscQueue<std::string> m_queue;
+
+    std::vector<std::unique_ptr<Row>> m_rows; // row of line seq = m_rows[seq % size]
+    std::uint64_t m_shown_newest = 0;   // lines newest, newest-1... drawn this frame
+    std::size_t m_shown = 0;
+    std::string m_font_path;
+    int m_text_size = 3;
+    float m_text_color[4] = {0.85f, 0.85f, 0.88f, 1.0f};
+    float m_bg[4] = {0.02f, 0.02f, 0.03f, 0.80f};
+    float m_padding = 6.0f;
+};
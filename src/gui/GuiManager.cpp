@@ -34,11 +34,19 @@ bool GuiManager::hasPage(const std::string& name) const
     return m_pages.find(name) != m_pages.end();
 }
 
-void GuiManager::draw()
+void GuiManager::update(float dt, GuiInputState& input)
+{
+    if (!m_active.has_value()) return;
+    auto it = m_pages.find(*m_active);
+    if (it == m_pages.end()) return;
+    // Update only the active page; elements of other pages won't process input
+    it->second.update(dt, input);
+}
+
+void GuiManager::draw() const
 {
     if (!m_active.has_value()) return;
     auto it = m_pages.find(*m_active);
     if (it == m_pages.end()) return;
-    // Draw only the active page; elements of other pages won't process input
     it->second.draw();
 }
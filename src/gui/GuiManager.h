@@ -7,9 +7,10 @@
 #include <utility>
 #include "GuiPanel.h"
 
-// GuiManager stores named GUI pages (each a GuiPanel) and draws only the active one.
+// GuiManager stores named GUI pages (each a GuiPanel) and runs only the active one.
 // - addPage: registers/replaces a page by name (copy or move into manager)
-// - setActivePage: selects the page to be drawn
+// - setActivePage: selects the page to be updated and drawn
+// - update: input, state and layout of the active page
 // - draw: draws only the active page (no state mutation on panels)
 class GuiManager {
 public:
@@ -22,8 +23,11 @@ public:
     // Sets the active page by name. If not found, does nothing.
     void setActivePage(const std::string& name);
 
+    // Update only the active page (if any): other pages do not process input.
+    void update(float dt, GuiInputState& input);
+
     // Draw only the active page (if any).
-    void draw();
+    void draw() const;
 
     // Optional helpers
     bool hasPage(const std::string& name) const;
@@ -2,6 +2,7 @@
 
 #include "GuiMenuBar.h"
 #include "GuiDraw.h"
+#include "GuiHitTest.h"
 #include "GuiInput.h"
 
 #include <algorithm>
@@ -15,7 +16,10 @@ void GuiMenuBar::add_menu(const std::string& label)
 {
     // Avoid duplicates
     auto it = std::find_if(m_menus.begin(), m_menus.end(), [&](const Menu& m){ return m.label == label; });
-    if (it == m_menus.end()) m_menus.push_back(Menu{label, {}});
+    if (it == m_menus.end()) {
+        m_menus.push_back(Menu{label, {}});
+        mark_layout_dirty();
+    }
 }
 
 void GuiMenuBar::add_menu_item(const std::string& menu, const std::string& item_label, std::function<void()> callback)
@@ -24,6 +28,7 @@ void GuiMenuBar::add_menu_item(const std::string& menu, const std::string& item_
     if (it == m_menus.end()) {
         m_menus.push_back(Menu{menu, {}});
         it = std::prev(m_menus.end());
+        mark_layout_dirty();
     }
     it->items.push_back(Item{item_label, std::move(callback)});
 }
@@ -35,12 +40,30 @@ void GuiMenuBar::onMenuSelect(const std::string& /*menu*/, const std::string& /*
 
 bool GuiMenuBar::set_text_font(const std::string& path)
 {
+    mark_layout_dirty();
+    m_font_path = path;
+    reset_slots();
     return m_label_helper.set_text_font(path);
 }
 
 void GuiMenuBar::set_text_size(int sz_1_to_10)
 {
     m_label_helper.set_text_size(sz_1_to_10);
+    m_text_size = sz_1_to_10;
+    reset_slots();
+    mark_layout_dirty();
+}
+
+GuiMenuBar::Slot& GuiMenuBar::slot(std::size_t index)
+{
+    while (m_slots.size() <= index) {
+        Slot s;
+        s.text.reset(new GuiText());
+        if (!m_font_path.empty()) s.text->set_text_font(m_font_path);
+        s.text->set_text_size(m_text_size);
+        m_slots.push_back(std::move(s));
+    }
+    return m_slots[index];
 }
 
 void GuiMenuBar::set_colors(float bg_r, float bg_g, float bg_b, float bg_a,
@@ -55,97 +78,113 @@ std::pair<float,float> GuiMenuBar::preferred_size() const
     if (m_size_w > 0.0f && m_size_h > 0.0f) return {pixel_w(), pixel_h()};
     // Height from text size + padding; width sum of labels + spacing
     float width = m_pad_x * 2.0f;
-    m_label_helper.set_text("X");
     float height = std::max(22.0f, m_label_helper.preferred_size().second + 2.0f * m_pad_y);
     for (const auto& m : m_menus) {
-        m_label_helper.set_text(m.label);
-        width += m_label_helper.preferred_size().first + m_spacing;
+        // Measured directly: no glyph run is built for each label
+        float lw = 0.0f, asc = 0.0f, desc = 0.0f;
+        m_label_helper.measure_text(m.label, lw, asc, desc);
+        width += lw + m_spacing;
     }
     return {std::max(200.0f, width), height};
 }
 
-void GuiMenuBar::draw()
+void GuiMenuBar::update(float dt, GuiInputState& input)
 {
     if (!m_visible) return;
     float x = pixel_x();
     float y = pixel_y();
-    float w = pixel_w();
-    float h = pixel_h();
+    float w = box_w();
+    float h = box_h();
     if (w <= 0.0f || h <= 0.0f) {
         auto ps = preferred_size();
         if (w <= 0.0f) w = ps.first;
         if (h <= 0.0f) h = ps.second;
     }
-    if (w <= 0.0f || h <= 0.0f) return;
-
-    GuiDraw::draw_rect(x, y, w, h, m_bg);
-
-    const auto [mx, my] = GuiInput::mouse_pos_px();
+    m_rect = DrawRect{x, y, w, h, w > 0.0f && h > 0.0f};
+    m_slot_count = 0;
+    m_drop[2] = 0.0f;
+    if (!m_rect.valid) return;
+    // An open dropdown may still be on screen
+    if (m_open_menu < 0 && culled(x, y, w, h)) { m_rect.valid = false; return; }
+
+    // Cells below test the pointer only when the bar or its dropdown is on top
+    add_hit_rect(x, y, w, h);
+    const bool routed = input.hover == this;
+    const float mx = static_cast<float>(input.mouse_x);
+    const float my = static_cast<float>(input.mouse_y);
 
     // Layout top-level menus
     float pen_x = x + m_pad_x;
+    float open_x = pen_x;
+    float open_w = 0.0f;
     int hovered_menu = -1;
     for (int i = 0; i < static_cast<int>(m_menus.size()); ++i) {
-        const auto& m = m_menus[i];
-        m_label_helper.set_text(m.label);
-        auto sz = m_label_helper.preferred_size();
+        Slot& s = slot(m_slot_count++);
+        s.text->set_text(m_menus[i].label);
+        auto sz = s.text->preferred_size();
         float bx = pen_x - 4.0f;
         float by = y;
         float bw = sz.first + 8.0f;
         float bh = h;
-        bool hovered = (mx >= bx && mx <= bx + bw && my >= by && my <= by + bh);
+        bool hovered = routed && (mx >= bx && mx <= bx + bw && my >= by && my <= by + bh);
         if (hovered) hovered_menu = i;
-        if (i == m_open_menu || hovered) {
-            GuiDraw::draw_rect(bx, by, bw, bh, m_hi);
-        }
-        float asc=0.0f, desc=0.0f; bool have = m_label_helper.vertical_extents(asc, desc);
+        if (i == m_open_menu) { open_x = bx; open_w = bw; }
+        s.rect[0] = bx; s.rect[1] = by; s.rect[2] = bw; s.rect[3] = bh;
+        s.highlight = (i == m_open_menu || hovered);
+        float asc=0.0f, desc=0.0f; bool have = s.text->vertical_extents(asc, desc);
         float base_y = have ? (y + (h - (asc - desc)) * 0.5f + (asc - desc) * 0.6f)
                             : (y + (h - sz.second) * 0.5f + sz.second * 0.6f);
-        m_label_helper.set_position(pen_x, base_y, false);
-        m_label_helper.draw();
+        s.text->set_position(pen_x, base_y, false);
+        s.text->update(dt, input);
         pen_x += sz.first + m_spacing;
     }
+    m_bar_slots = m_slot_count;
 
-    // Draw dropdown for open menu
+    // Dropdown for open menu, under its label
     int hovered_item = -1;
     if (m_open_menu >= 0 && m_open_menu < static_cast<int>(m_menus.size())) {
-        // Find rect of the open menu again (to place dropdown)
-        pen_x = x + m_pad_x;
-        for (int i = 0; i < m_open_menu; ++i) {
-            m_label_helper.set_text(m_menus[i].label);
-            pen_x += m_label_helper.preferred_size().first + m_spacing;
-        }
-        m_label_helper.set_text(m_menus[m_open_menu].label);
-        float menu_w = m_label_helper.preferred_size().first + 8.0f;
-        float drop_x = pen_x - 4.0f;
+        const auto& items = m_menus[m_open_menu].items;
+        float drop_x = open_x;
         float drop_y = y - 2.0f; // just under bar
         // Compute dropdown width based on items
         float item_h = m_label_helper.preferred_size().second + 8.0f;
-        float max_w = menu_w;
-        for (const auto& it : m_menus[m_open_menu].items) {
-            m_label_helper.set_text(it.label);
-            max_w = std::max(max_w, m_label_helper.preferred_size().first + 12.0f);
+        float max_w = open_w;
+        for (const auto& it : items) {
+            float iw = 0.0f, asc = 0.0f, desc = 0.0f;
+            m_label_helper.measure_text(it.label, iw, asc, desc);
+            max_w = std::max(max_w, iw + 12.0f);
         }
-        float drop_h = static_cast<float>(m_menus[m_open_menu].items.size()) * item_h + 4.0f;
-        GuiDraw::draw_rect(drop_x, drop_y - drop_h, max_w, drop_h, m_bg);
-
-        // Items
-        for (int idx = 0; idx < static_cast<int>(m_menus[m_open_menu].items.size()); ++idx) {
+        float drop_h = static_cast<float>(items.size()) * item_h + 4.0f;
+        m_drop[0] = drop_x; m_drop[1] = drop_y - drop_h; m_drop[2] = max_w; m_drop[3] = drop_h;
+        add_hit_rect(m_drop[0], m_drop[1], m_drop[2], m_drop[3], true); // popup
+
+        // Items: the popup is not clipped by the containers of the bar
+        int fw = 0, fh = 0;
+        get_framebuffer_size(fw, fh);
+        const bool escape = fw > 0 && fh > 0;
+        GuiHitTest& hits = GuiHitTest::instance();
+        if (escape) hits.push_clip(0.0f, 0.0f, static_cast<float>(fw), static_cast<float>(fh), false);
+        for (int idx = 0; idx < static_cast<int>(items.size()); ++idx) {
             float iy = drop_y - (idx+1) * item_h;
-            bool item_hovered = (mx >= drop_x && mx <= drop_x + max_w && my >= iy && my <= iy + item_h);
-            if (item_hovered) { hovered_item = idx; GuiDraw::draw_rect(drop_x, iy, max_w, item_h, m_hi); }
-            m_label_helper.set_text(m_menus[m_open_menu].items[idx].label);
-            auto isz = m_label_helper.preferred_size();
-            float asc=0.0f, desc=0.0f; bool have = m_label_helper.vertical_extents(asc, desc);
+            bool item_hovered = routed && (mx >= drop_x && mx <= drop_x + max_w && my >= iy && my <= iy + item_h);
+            if (item_hovered) hovered_item = idx;
+            Slot& s = slot(m_slot_count++);
+            s.text->set_text(items[idx].label);
+            s.rect[0] = drop_x; s.rect[1] = iy; s.rect[2] = max_w; s.rect[3] = item_h;
+            s.highlight = item_hovered;
+            auto isz = s.text->preferred_size();
+            float asc=0.0f, desc=0.0f; bool have = s.text->vertical_extents(asc, desc);
             float base_y = have ? (iy + (item_h - (asc - desc)) * 0.5f + (asc - desc) * 0.6f)
                                 : (iy + (item_h - isz.second) * 0.5f + isz.second * 0.6f);
-            m_label_helper.set_position(drop_x + 6.0f, base_y, false);
-            m_label_helper.draw();
+            s.text->set_position(drop_x + 6.0f, base_y, false);
+            s.text->update(dt, input);
         }
+        if (escape) hits.pop_clip();
     }
 
-    // Click handling: prioritize dropdown items, then top-level, else close
-    if (GuiInput::left_clicked()) {
+    // Click handling: prioritize dropdown items, then top-level, else close.
+    // The new state shows from the next update.
+    if (input.left_clicked) {
         if (m_open_menu >= 0 && hovered_item >= 0) {
             auto cb = m_menus[m_open_menu].items[hovered_item].cb;
             auto menu_label = m_menus[m_open_menu].label;
@@ -160,3 +199,25 @@ void GuiMenuBar::draw()
         }
     }
 }
+
+void GuiMenuBar::draw() const
+{
+    if (!m_visible || !m_rect.valid) return;
+    GuiDraw::draw_rect(m_rect.x, m_rect.y, m_rect.w, m_rect.h, m_bg);
+    auto draw_slot = [this](std::size_t i) {
+        const Slot& s = m_slots[i];
+        if (s.highlight) GuiDraw::draw_rect(s.rect[0], s.rect[1], s.rect[2], s.rect[3], m_hi);
+        s.text->draw();
+    };
+    for (std::size_t i = 0; i < m_bar_slots; ++i) draw_slot(i);
+    if (m_drop[2] <= 0.0f) return;
+
+    // Dropdown background, then the items; not clipped by the containers of the bar
+    int fw = 0, fh = 0;
+    get_framebuffer_size(fw, fh);
+    const bool escape = fw > 0 && fh > 0;
+    if (escape) GuiDraw::push_clip(0.0f, 0.0f, static_cast<float>(fw), static_cast<float>(fh), false);
+    GuiDraw::draw_rect(m_drop[0], m_drop[1], m_drop[2], m_drop[3], m_bg);
+    for (std::size_t i = m_bar_slots; i < m_slot_count; ++i) draw_slot(i);
+    if (escape) GuiDraw::pop_clip();
+}
@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 #include <functional>
+#include <memory>
 
 #include "GuiElement.h"
 #include "GuiText.h"
@@ -20,17 +21,34 @@ public:
     void set_text_size(int sz_1_to_10);
     void set_colors(float bg_r, float bg_g, float bg_b, float bg_a,
                     float hi_r, float hi_g, float hi_b, float hi_a);
-    void set_spacing(float s) { m_spacing = (s < 0.f ? 0.f : s); }
-    void set_padding(float px, float py) { m_pad_x = (px < 0 ? 0.f : px); m_pad_y = (py < 0 ? 0.f : py); }
+    void set_spacing(float s) { m_spacing = (s < 0.f ? 0.f : s); mark_layout_dirty(); }
+    void set_padding(float px, float py) { m_pad_x = (px < 0 ? 0.f : px); m_pad_y = (py < 0 ? 0.f : py); mark_layout_dirty(); }
 
-    void draw() override;
+    void update(float dt, GuiInputState& input) override;
+    void draw() const override;
     std::pair<float,float> preferred_size() const override;
 
 private:
     struct Item { std::string label; std::function<void()> cb; };
     struct Menu { std::string label; std::vector<Item> items; };
     std::vector<Menu> m_menus;
-    mutable GuiText m_label_helper; // for measuring and rendering labels
+    GuiText m_label_helper; // for measuring labels (font and size of all labels)
+
+    // Labels shown this frame, laid out by update(): the top-level menus,
+    // then the items of the open menu. Each slot keeps its GuiText (and run).
+    struct Slot {
+        std::unique_ptr<GuiText> text;
+        float rect[4] = {0.f, 0.f, 0.f, 0.f}; // highlight cell
+        bool highlight = false;
+    };
+    Slot& slot(std::size_t index);
+    void reset_slots() { m_slots.clear(); }
+    std::vector<Slot> m_slots;
+    std::size_t m_slot_count = 0;  // slots in use
+    std::size_t m_bar_slots = 0;   // of which top-level menus
+    float m_drop[4] = {0.f, 0.f, 0.f, 0.f}; // open dropdown rect (w = 0: closed)
+    std::string m_font_path;
+    int m_text_size = 3;
     float m_bg[4] = {0.10f, 0.10f, 0.12f, 1.0f};
     float m_hi[4] = {0.20f, 0.30f, 0.55f, 1.0f};
     float m_spacing = 16.0f;
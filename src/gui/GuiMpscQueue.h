@@ -0,0 +1,68 @@
+// GuiMpscQueue.h - Lock-free multi-producer / single-consumer queue
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+// Intrusive MPSC queue (Vyukov): push() is wait-free (one atomic exchange)
+// and may be called from any thread; pop() belongs to a single consumer
+// thread (the GUI thread). A pop() racing a push() that has swapped the
+// head but not yet linked its node reports empty; the value shows up on
+// the next pop(). Nodes are heap-allocated per push.
+template <class T>
+class GuiMpscQueue {
+public:
+    GuiMpscQueue() : m_head(&m_stub), m_tail(&m_stub) {}
+    ~GuiMpscQueue()
+    {
+        T value;
+        while (pop(value)) {}
+    }
+    GuiMpscQueue(const GuiMpscQueue&) = delete;
+    GuiMpscQueue& operator=(const GuiMpscQueue&) = delete;
+
+    void push(T value) { push_node(new Node(std::move(value))); }
+
+    // Consumer thread only
+    bool pop(T& out)
+    {
+        Node* tail = m_tail;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (tail == &m_stub) {
+            if (!next) return false;
+            m_tail = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (!next) {
+            // tail is the last node: re-insert the stub behind it to detach it
+            if (tail != m_head.load(std::memory_order_acquire)) return false; // push in progress
+            push_node(&m_stub);
+            next = tail->next.load(std::memory_order_acquire);
+            if (!next) return false;
+        }
+        m_tail = next;
+        out = std::move(tail->value);
+        delete tail;
+        return true;
+    }
+
+private:
+    struct Node {
+        Node() = default;
+        explicit Node(T v) : value(std::move(v)) {}
+        std::atomic<Node*> next{nullptr};
+        T value{};
+    };
+
+    void push_node(Node* node)
+    {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        Node* prev = m_head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    alignas(64) std::atomic<Node*> m_head; // producers
+    alignas(64) Node* m_tail;              // consumer
+    Node m_stub;
+};
@@ -2,164 +2,84 @@
 
 #include "GuiPanel.h"
 #include "GuiText.h" // for preferred_size implementation use; not strictly required
+#include "GuiDraw.h"
+#include "GuiHitTest.h"
 
-#include <glad/glad.h>
-
-#include <cstdio>
 #include <cmath>
 
-// Static GL resources
-unsigned int GuiPanel::s_vao = 0;
-unsigned int GuiPanel::s_vbo = 0;
-unsigned int GuiPanel::s_shader = 0;
-int GuiPanel::s_uProjLoc = -1;
-int GuiPanel::s_uRectMinLoc = -1;
-int GuiPanel::s_uRectMaxLoc = -1;
-int GuiPanel::s_uRadiusLoc = -1;
-int GuiPanel::s_uBgColorLoc = -1;
-int GuiPanel::s_uBorderColorLoc = -1;
-int GuiPanel::s_uBorderThicknessLoc = -1;
-
 namespace {
 
-static void make_ortho(float left, float right, float bottom, float top, float znear, float zfar, float out[16])
+// Bounds of 0 are unset; min wins over max
+float clamp_size(float v, float min_v, float max_v)
 {
-    for (int i=0;i<16;++i) out[i] = 0.0f;
-    out[0] = 2.0f / (right - left);
-    out[5] = 2.0f / (top - bottom);
-    out[10] = -2.0f / (zfar - znear);
-    out[12] = - (right + left) / (right - left);
-    out[13] = - (top + bottom) / (top - bottom);
-    out[14] = - (zfar + znear) / (zfar - znear);
-    out[15] = 1.0f;
+    if (max_v > 0.0f && v > max_v) v = max_v;
+    if (min_v > 0.0f && v < min_v) v = min_v;
+    return v;
 }
 
-static unsigned int compile_shader(GLenum type, const char* src)
+} // namespace
+
+GuiPanel::GuiPanel() {}
+
+GuiPanel::~GuiPanel()
 {
-    GLuint sh = glCreateShader(type);
-    glShaderSource(sh, 1, &src, nullptr);
-    glCompileShader(sh);
-    GLint ok = GL_FALSE;
-    glGetShaderiv(sh, GL_COMPILE_STATUS, &ok);
-    if (!ok) {
-        GLint len = 0; glGetShaderiv(sh, GL_INFO_LOG_LENGTH, &len);
-        std::string log(len > 0 ? len : 1, '\0');
-        glGetShaderInfoLog(sh, len, nullptr, log.data());
-        std::fprintf(stderr, "[GuiPanel] Shader compile error (%s):\n%s\n", type==GL_VERTEX_SHADER?"VERTEX":"FRAGMENT", log.c_str());
-        glDeleteShader(sh);
-        return 0;
+    // Children destroyed earlier have removed themselves already
+    for (auto* child : m_children) {
+        if (child && child->layout_parent() == this) child->set_layout_parent(nullptr);
     }
-    return sh;
 }
 
-static unsigned int link_program(GLuint vs, GLuint fs)
+GuiPanel::GuiPanel(GuiPanel&& other) noexcept
 {
-    GLuint p = glCreateProgram();
-    glAttachShader(p, vs);
-    glAttachShader(p, fs);
-    glLinkProgram(p);
-    GLint ok = GL_FALSE;
-    glGetProgramiv(p, GL_LINK_STATUS, &ok);
-    if (!ok) {
-        GLint len = 0; glGetProgramiv(p, GL_INFO_LOG_LENGTH, &len);
-        std::string log(len > 0 ? len : 1, '\0');
-        glGetProgramInfoLog(p, len, nullptr, log.data());
-        std::fprintf(stderr, "[GuiPanel] Program link error:\n%s\n", log.c_str());
-        glDeleteProgram(p);
-        return 0;
-    }
-    return p;
+    *this = std::move(other);
 }
 
-} // namespace
-
-bool GuiPanel::ensure_gl_resources()
+GuiPanel& GuiPanel::operator=(GuiPanel&& other) noexcept
 {
-    if (s_shader && s_vao && s_vbo) return true;
-
-    if (s_vao == 0) {
-        glGenVertexArrays(1, &s_vao);
-        glBindVertexArray(s_vao);
-        glGenBuffers(1, &s_vbo);
-        glBindBuffer(GL_ARRAY_BUFFER, s_vbo);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 12, nullptr, GL_DYNAMIC_DRAW); // 2D quad (6 verts * 2 floats)
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-        glBindVertexArray(0);
+    if (this == &other) return *this;
+    for (auto* child : m_children) {
+        if (child && child->layout_parent() == this) child->set_layout_parent(nullptr);
     }
-
-    if (s_shader == 0) {
-        static const char* VERT = R"GLSL(
-            #version 330 core
-            layout(location = 0) in vec2 aPos; // in pixel space
-            uniform mat4 uProjection;
-            void main() {
-                gl_Position = uProjection * vec4(aPos.xy, 0.0, 1.0);
-            }
-        )GLSL";
-        static const char* FRAG = R"GLSL(
-            #version 330 core
-            out vec4 FragColor;
-            uniform vec2 uRectMin;
-            uniform vec2 uRectMax;
-            uniform float uRadius;
-            uniform vec4 uBgColor;
-            uniform vec4 uBorderColor;
-            uniform float uBorderThickness;
-
-            // Signed distance field for rounded box in window coords
-            float sdRoundBox(vec2 p, vec2 b, float r)
-            {
-                vec2 q = abs(p) - (b - vec2(r));
-                return length(max(q, 0.0)) - r;
-            }
-
-            void main() {
-                vec2 rectSize = uRectMax - uRectMin;
-                vec2 center = uRectMin + rectSize * 0.5;
-                vec2 p = gl_FragCoord.xy - center; // window coords, origin bottom-left
-                vec2 halfSize = rectSize * 0.5;
-                float d = sdRoundBox(p, halfSize, uRadius);
-                if (d > 0.0) discard; // outside rounded rect
-
-                // Border if within thickness band near edge (inside)
-                float inner = d + uBorderThickness;
-                vec4 color = (inner > 0.0 && uBorderColor.a > 0.0) ? uBorderColor : uBgColor;
-                FragColor = color;
-            }
-        )GLSL";
-
-        GLuint vs = compile_shader(GL_VERTEX_SHADER, VERT);
-        GLuint fs = compile_shader(GL_FRAGMENT_SHADER, FRAG);
-        if (!vs || !fs) return false;
-        s_shader = link_program(vs, fs);
-        glDeleteShader(vs);
-        glDeleteShader(fs);
-        if (!s_shader) return false;
-        s_uProjLoc = glGetUniformLocation(s_shader, "uProjection");
-        s_uRectMinLoc = glGetUniformLocation(s_shader, "uRectMin");
-        s_uRectMaxLoc = glGetUniformLocation(s_shader, "uRectMax");
-        s_uRadiusLoc = glGetUniformLocation(s_shader, "uRadius");
-        s_uBgColorLoc = glGetUniformLocation(s_shader, "uBgColor");
-        s_uBorderColorLoc = glGetUniformLocation(s_shader, "uBorderColor");
-        s_uBorderThicknessLoc = glGetUniformLocation(s_shader, "uBorderThickness");
+    GuiElement::operator=(std::move(other));
+    m_children = std::move(other.m_children);
+    other.m_children.clear();
+    std::copy(other.m_bg, other.m_bg + 4, m_bg);
+    std::copy(other.m_border, other.m_border + 4, m_border);
+    m_radius = other.m_radius;
+    m_border_thickness = other.m_border_thickness;
+    m_padding = other.m_padding;
+    m_spacing = other.m_spacing;
+    m_layout = other.m_layout;
+    m_flex_direction = other.m_flex_direction;
+    m_flex_wrap = other.m_flex_wrap;
+    m_justify = other.m_justify;
+    m_align_items = other.m_align_items;
+    m_clip_children = other.m_clip_children;
+    std::copy(other.m_laid_rect, other.m_laid_rect + 4, m_laid_rect);
+    m_laid_fb[0] = other.m_laid_fb[0]; m_laid_fb[1] = other.m_laid_fb[1];
+    for (auto* child : m_children) {
+        if (child) child->set_layout_parent(this);
     }
-    return true;
+    return *this;
 }
 
-GuiPanel::GuiPanel() {}
-GuiPanel::~GuiPanel() {}
-
 void GuiPanel::addChild(GuiElement* element)
 {
     if (!element) return;
+    // One container per element: it leaves the previous one
+    if (GuiElement* previous = element->layout_parent()) previous->remove_layout_child(element);
     m_children.push_back(element);
+    element->set_layout_parent(this);
+    element->mark_layout_dirty();
 }
 
 void GuiPanel::removeChild(GuiElement* element)
 {
     auto it = std::remove(m_children.begin(), m_children.end(), element);
+    if (it == m_children.end()) return;
     m_children.erase(it, m_children.end());
+    if (element && element->layout_parent() == this) element->set_layout_parent(nullptr);
+    mark_layout_dirty();
 }
 
 void GuiPanel::setBackgroundColor(float r, float g, float b, float a)
@@ -184,85 +104,82 @@ void GuiPanel::setBorderThickness(float t)
     m_border_thickness = t;
 }
 
-void GuiPanel::setLayout(LayoutType type) { m_layout = type; }
-void GuiPanel::setPadding(float p) { m_padding = (p < 0.0f) ? 0.0f : p; }
-void GuiPanel::setSpacing(float s) { m_spacing = (s < 0.0f) ? 0.0f : s; }
+void GuiPanel::setLayout(LayoutType type) { m_layout = type; mark_layout_dirty(); }
+void GuiPanel::setPadding(float p) { m_padding = (p < 0.0f) ? 0.0f : p; mark_layout_dirty(); }
+void GuiPanel::setSpacing(float s) { m_spacing = (s < 0.0f) ? 0.0f : s; mark_layout_dirty(); }
+void GuiPanel::setFlexDirection(FlexDirection d) { m_flex_direction = d; mark_layout_dirty(); }
+void GuiPanel::setFlexWrap(bool wrap) { m_flex_wrap = wrap; mark_layout_dirty(); }
+void GuiPanel::setJustifyContent(FlexJustify j) { m_justify = j; mark_layout_dirty(); }
+void GuiPanel::setAlignItems(FlexAlign a) { m_align_items = a; mark_layout_dirty(); }
 
-void GuiPanel::draw()
+void GuiPanel::update(float dt, GuiInputState& input)
 {
     if (!m_visible) return;
-    if (!ensure_gl_resources()) return;
 
     // Determine pixel rect for this panel
-    float w = pixel_w();
-    float h = pixel_h();
-    if (w <= 0.0f || h <= 0.0f) return;
+    float w = box_w();
+    float h = box_h();
+    m_rect.valid = w > 0.0f && h > 0.0f;
+    if (!m_rect.valid) return;
 
     // Support alignment relative to parent (framebuffer if none)
     float x = 0.0f, y = 0.0f;
     compute_aligned_xy(w, h, x, y);
     // Apply animations (offset + scaling) to this panel rect
     apply_animation_to_rect(x, y, w, h);
+    m_rect = DrawRect{x, y, w, h, true};
+    m_culled = culled(x, y, w, h);
+    // Clipped children of a culled panel are culled too: not even laid out
+    // (the rect changes when the panel comes back into view)
+    if (m_culled && m_clip_children) return;
+    // A visible background takes the pointer from what is below the panel
+    if (!m_culled && (m_bg[3] > 0.0f || (m_border[3] > 0.0f && m_border_thickness > 0.0f))) add_hit_rect(x, y, w, h);
+
+    // Lay out children within the inner rect when something changed. A resize
+    // changes percent-sized children even when this panel stays put.
+    int fw = 0, fh = 0;
+    get_framebuffer_size(fw, fh);
+    if (m_layout_dirty || x != m_laid_rect[0] || y != m_laid_rect[1] || w != m_laid_rect[2] || h != m_laid_rect[3] ||
+        fw != m_laid_fb[0] || fh != m_laid_fb[1]) {
+        arrange_children(x, y, w, h);
+        m_laid_rect[0] = x; m_laid_rect[1] = y; m_laid_rect[2] = w; m_laid_rect[3] = h;
+        m_laid_fb[0] = fw; m_laid_fb[1] = fh;
+        m_layout_dirty = false;
+    }
+    GuiHitTest& hits = GuiHitTest::instance();
+    if (m_clip_children) hits.push_clip(x, y, w, h);
+    for (auto* child : m_children) {
+        if (child && child->visible()) child->update(dt, input);
+    }
+    if (m_clip_children) hits.pop_clip();
+}
 
-    // Render state
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    GLboolean depthWasEnabled = glIsEnabled(GL_DEPTH_TEST);
-    if (depthWasEnabled) glDisable(GL_DEPTH_TEST); // HUD overlay
-
-    // Projection
-    int fw=0, fh=0; get_framebuffer_size(fw, fh);
-    float proj[16];
-    make_ortho(0.0f, static_cast<float>(fw), 0.0f, static_cast<float>(fh), -1.0f, 1.0f, proj);
-
-    // Draw panel quad (background + border via shader)
-    draw_panel_quad(x, y, w, h);
-
-    // Layout and draw children within inner rect
-    layout_children(x, y, w, h);
+void GuiPanel::draw() const
+{
+    if (!m_visible || !m_rect.valid) return;
 
-    if (depthWasEnabled) glEnable(GL_DEPTH_TEST);
+    // Draw panel quad (background + border via shader), then the children
+    if (!m_culled) draw_panel_quad(m_rect.x, m_rect.y, m_rect.w, m_rect.h);
+    if (m_clip_children) {
+        if (m_culled) return;
+        GuiDraw::push_clip(m_rect.x, m_rect.y, m_rect.w, m_rect.h);
+    }
+    for (const auto* child : m_children) {
+        if (child && child->visible()) child->draw();
+    }
+    if (m_clip_children) GuiDraw::pop_clip();
 }
 
-void GuiPanel::draw_panel_quad(float x, float y, float w, float h)
+void GuiPanel::draw_panel_quad(float x, float y, float w, float h) const
 {
-    // Vertex positions for the quad in pixel space (two triangles)
-    float verts[12] = {
-        x,     y,
-        x,     y + h,
-        x + w, y + h,
-
-        x,     y,
-        x + w, y + h,
-        x + w, y
-    };
-
-    int fw=0, fh=0; get_framebuffer_size(fw, fh);
-    float proj[16];
-    make_ortho(0.0f, static_cast<float>(fw), 0.0f, static_cast<float>(fh), -1.0f, 1.0f, proj);
-
-    glUseProgram(s_shader);
-    glUniformMatrix4fv(s_uProjLoc, 1, GL_FALSE, proj);
-    glUniform2f(s_uRectMinLoc, x, y);
-    glUniform2f(s_uRectMaxLoc, x + w, y + h);
-    glUniform1f(s_uRadiusLoc, m_radius);
     float bg_col[4];
     apply_animation_to_color(m_bg, bg_col);
     float border_col[4];
     apply_animation_to_color(m_border, border_col);
-    glUniform4fv(s_uBgColorLoc, 1, bg_col);
-    glUniform4fv(s_uBorderColorLoc, 1, border_col);
-    glUniform1f(s_uBorderThicknessLoc, m_border_thickness);
-
-    glBindVertexArray(s_vao);
-    glBindBuffer(GL_ARRAY_BUFFER, s_vbo);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(verts), verts);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
-    glUseProgram(0);
+    GuiDraw::draw_rounded_rect_bordered(x, y, w, h, m_radius, bg_col, border_col, m_border_thickness);
 }
 
-void GuiPanel::layout_children(float x, float y, float w, float h)
+void GuiPanel::arrange_children(float x, float y, float w, float h)
 {
     // Inner content rect
     const float cx = x + m_padding;
@@ -271,13 +188,20 @@ void GuiPanel::layout_children(float x, float y, float w, float h)
     const float ch = std::max(0.0f, h - 2.0f * m_padding);
 
     if (m_children.empty()) return;
+    int placed = 0;
+    for (auto* child : m_children) {
+        if (!child) continue;
+        child->set_layout_size(0.0f, 0.0f); // only FLEX assigns sizes
+        if (child->visible()) ++placed;
+    }
+    count_arranged(placed);
 
     switch (m_layout) {
         case LayoutType::HORIZONTAL: {
             float pen_x = cx;
             for (auto* child : m_children) {
                 if (!child || !child->visible()) continue;
-                auto [pw, ph] = child->preferred_size();
+                auto [pw, ph] = child->measure();
                 if (pw <= 0.0f) pw = 0.0f;
                 if (ph <= 0.0f) ph = 0.0f;
                 // Vertical alignment according to child's alignment inside panel's inner rect
@@ -286,7 +210,6 @@ void GuiPanel::layout_children(float x, float y, float w, float h)
                 float px = pen_x;
                 float py = pos.second; // honor vertical anchor
                 child->set_position(px, py, false);
-                child->draw();
                 pen_x += pw + m_spacing;
             }
         } break;
@@ -295,7 +218,7 @@ void GuiPanel::layout_children(float x, float y, float w, float h)
             float pen_y = cy + ch; // start at top
             for (auto* child : m_children) {
                 if (!child || !child->visible()) continue;
-                auto [pw, ph] = child->preferred_size();
+                auto [pw, ph] = child->measure();
                 if (pw <= 0.0f) pw = 0.0f;
                 if (ph <= 0.0f) ph = 0.0f;
                 pen_y -= ph; // place this element
@@ -304,7 +227,6 @@ void GuiPanel::layout_children(float x, float y, float w, float h)
                 auto pos = child->aligned_position_in(cx, cy, cw, ch, pw, ph);
                 float px = pos.first; // honor horizontal anchor
                 child->set_position(px, pen_y, false);
-                child->draw();
                 pen_y -= m_spacing;
             }
         } break;
@@ -323,13 +245,12 @@ void GuiPanel::layout_children(float x, float y, float w, float h)
                 int c = idx % cols;
                 float px = cx + c * (cell_w + m_spacing);
                 float py = cy + ch - (r + 1) * cell_h - r * m_spacing; // top to bottom
-                auto [pw, ph] = child->preferred_size();
+                auto [pw, ph] = child->measure();
                 // center inside cell
                 // Use child's alignment inside its cell rect
                 child->notify_parent_rect(px, py, cell_w, cell_h);
                 auto pos = child->aligned_position_in(px, py, cell_w, cell_h, pw, ph);
                 child->set_position(pos.first, pos.second, false);
-                child->draw();
                 ++idx;
             }
         } break;
@@ -339,15 +260,150 @@ void GuiPanel::layout_children(float x, float y, float w, float h)
             for (auto* child : m_children) {
                 if (!child || !child->visible()) continue;
                 child->notify_parent_rect(cx, cy, cw, ch);
-                auto [pw, ph] = child->preferred_size();
+                auto [pw, ph] = child->measure();
                 // If element has an explicit size, prefer it
                 if (pw <= 0.0f || ph <= 0.0f) {
                     // keep preferred values; drawers may handle unknown sizes
                 }
                 auto pos = child->aligned_position_in(cx, cy, cw, ch, pw, ph);
                 child->set_position(pos.first, pos.second, false);
-                child->draw();
             }
         } break;
+
+        case LayoutType::FLEX:
+            arrange_flex(cx, cy, cw, ch);
+            break;
+    }
+}
+
+void GuiPanel::arrange_flex(float cx, float cy, float cw, float ch)
+{
+    const bool row = m_flex_direction == FlexDirection::ROW;
+    const float avail_main = row ? cw : ch;
+    const float avail_cross = row ? ch : cw;
+    const float gap = m_spacing;
+
+    // Pass 1: measured sizes (cached per child), clamped, and line breaks
+    m_flex_slots.clear();
+    m_flex_lines.clear();
+    FlexLine line;
+    float line_main = 0.0f;
+    for (auto* child : m_children) {
+        if (!child || !child->visible()) continue;
+        const auto [pw, ph] = child->measure();
+        const auto [min_w, min_h] = child->min_size();
+        const auto [max_w, max_h] = child->max_size();
+        FlexSlot s;
+        s.child = child;
+        s.min_main = row ? min_w : min_h;
+        s.max_main = row ? max_w : max_h;
+        s.min_cross = row ? min_h : min_w;
+        s.max_cross = row ? max_h : max_w;
+        s.base = clamp_size(std::max(0.0f, row ? pw : ph), s.min_main, s.max_main);
+        s.cross = clamp_size(std::max(0.0f, row ? ph : pw), s.min_cross, s.max_cross);
+        if (m_flex_wrap && line.end > line.begin && line_main + gap + s.base > avail_main) {
+            m_flex_lines.push_back(line);
+            line = FlexLine{};
+            line.begin = line.end = m_flex_slots.size();
+            line_main = 0.0f;
+        }
+        line_main += (line.end > line.begin ? gap : 0.0f) + s.base;
+        line.cross = std::max(line.cross, s.cross);
+        m_flex_slots.push_back(s);
+        line.end = m_flex_slots.size();
+    }
+    if (line.end > line.begin) m_flex_lines.push_back(line);
+    // A single line spans the whole cross size
+    if (!m_flex_wrap && m_flex_lines.size() == 1) m_flex_lines[0].cross = avail_cross;
+
+    // Pass 2: per line, resolve main sizes, then place along and across it
+    float cross_pen = 0.0f;
+    for (const FlexLine& l : m_flex_lines) {
+        FlexSlot* slots = m_flex_slots.data() + l.begin;
+        const std::size_t n = l.end - l.begin;
+        const float gaps = gap * static_cast<float>(n - 1);
+        resolve_flex_line(slots, n, avail_main - gaps);
+
+        float used = gaps;
+        for (std::size_t k = 0; k < n; ++k) used += slots[k].main;
+        const float free = std::max(0.0f, avail_main - used);
+        const float count = static_cast<float>(n);
+        float lead = 0.0f, between = gap;
+        switch (m_justify) {
+            case FlexJustify::START: break;
+            case FlexJustify::END: lead = free; break;
+            case FlexJustify::CENTER: lead = free * 0.5f; break;
+            case FlexJustify::SPACE_BETWEEN: if (n > 1) between += free / (count - 1.0f); break;
+            case FlexJustify::SPACE_AROUND: lead = free / count * 0.5f; between += free / count; break;
+            case FlexJustify::SPACE_EVENLY: lead = free / (count + 1.0f); between += free / (count + 1.0f); break;
+        }
+
+        float main_pen = lead;
+        for (std::size_t k = 0; k < n; ++k) {
+            const FlexSlot& s = slots[k];
+            float cross = s.cross;
+            float cross_off = 0.0f;
+            switch (m_align_items) {
+                case FlexAlign::START: break;
+                case FlexAlign::END: cross_off = l.cross - cross; break;
+                case FlexAlign::CENTER: cross_off = (l.cross - cross) * 0.5f; break;
+                case FlexAlign::STRETCH: cross = clamp_size(l.cross, s.min_cross, s.max_cross); break;
+            }
+            // Main axis runs left to right (ROW) or top to bottom (COLUMN),
+            // the cross axis top to bottom or left to right
+            const float w = row ? s.main : cross;
+            const float h = row ? cross : s.main;
+            const float x = row ? cx + main_pen : cx + cross_pen + cross_off;
+            const float y = row ? cy + ch - (cross_pen + cross_off) - h : cy + ch - main_pen - h;
+            s.child->set_layout_size(w, h);
+            s.child->notify_parent_rect(cx, cy, cw, ch);
+            s.child->set_position(x, y, false);
+            main_pen += s.main + between;
+        }
+        cross_pen += l.cross + gap;
+    }
+}
+
+void GuiPanel::resolve_flex_line(FlexSlot* slots, std::size_t count, float space)
+{
+    // Grow when the bases leave free space, shrink when they overflow. Items
+    // pushed past a bound are frozen there and the others share what is left
+    // again: each round freezes at least one item (usually one round is enough)
+    float base_sum = 0.0f;
+    for (std::size_t k = 0; k < count; ++k) base_sum += slots[k].base;
+    const bool grow = space > base_sum;
+    for (std::size_t k = 0; k < count; ++k) {
+        FlexSlot& s = slots[k];
+        s.main = s.base;
+        s.frozen = grow ? (s.child->flex_grow() <= 0.0f) : (s.child->flex_shrink() <= 0.0f || s.base <= 0.0f);
+    }
+    if (space == base_sum) return;
+
+    for (std::size_t round = 0; round <= count; ++round) {
+        float free = space;
+        float weight = 0.0f;
+        for (std::size_t k = 0; k < count; ++k) {
+            const FlexSlot& s = slots[k];
+            free -= s.frozen ? s.main : s.base;
+            if (!s.frozen) weight += grow ? s.child->flex_grow() : s.child->flex_shrink() * s.base;
+        }
+        if (weight <= 0.0f) return;
+
+        float violation = 0.0f;
+        for (std::size_t k = 0; k < count; ++k) {
+            FlexSlot& s = slots[k];
+            if (s.frozen) continue;
+            const float share = grow ? s.child->flex_grow() : s.child->flex_shrink() * s.base;
+            s.target = s.base + free * share / weight;
+            s.main = clamp_size(std::max(0.0f, s.target), s.min_main, s.max_main);
+            violation += s.main - s.target;
+        }
+        if (violation == 0.0f) return;
+        // Freeze the items clamped in the direction of the total violation
+        for (std::size_t k = 0; k < count; ++k) {
+            FlexSlot& s = slots[k];
+            if (s.frozen) continue;
+            if ((violation > 0.0f && s.main > s.target) || (violation < 0.0f && s.main < s.target)) s.frozen = true;
+        }
     }
 }
@@ -7,15 +7,19 @@
 
 class GuiPanel : public GuiElement {
 public:
-    enum class LayoutType { HORIZONTAL, VERTICAL, GRID, ABSOLUTE };
+    enum class LayoutType { HORIZONTAL, VERTICAL, GRID, ABSOLUTE, FLEX };
+    enum class FlexDirection { ROW, COLUMN };   // left to right / top to bottom
+    enum class FlexJustify { START, END, CENTER, SPACE_BETWEEN, SPACE_AROUND, SPACE_EVENLY };
+    enum class FlexAlign { START, END, CENTER, STRETCH };
 
     GuiPanel();
     ~GuiPanel();
-    GuiPanel(GuiPanel&&) noexcept = default;
-    GuiPanel& operator=(GuiPanel&&) noexcept = default;
+    GuiPanel(GuiPanel&& other) noexcept;
+    GuiPanel& operator=(GuiPanel&& other) noexcept; // children are re-parented
 
     void addChild(GuiElement* element);
     void removeChild(GuiElement* element);
+    void remove_layout_child(GuiElement* child) override { removeChild(child); }
 
     void setBackgroundColor(float r, float g, float b, float a);
     void setBorderColor(float r, float g, float b, float a);
@@ -24,15 +28,41 @@ public:
 
     void setLayout(LayoutType type);
     void setPadding(float p);
-    void setSpacing(float s);
+    void setSpacing(float s); // FLEX: gap between items and between lines
 
-    void draw() override;
+    // FLEX layout: items keep their preferred size along the main axis
+    // (clamped to their min/max size), then share the free space by their
+    // grow factors or the overflow by their shrink factors (see
+    // GuiElement::set_flex). With wrap, items that do not fit start a new
+    // line. Justify places items along a line, align across it (STRETCH
+    // gives them the line's cross size). Two passes over the children:
+    // measure and break lines, then resolve sizes and place.
+    void setFlexDirection(FlexDirection d);
+    void setFlexWrap(bool wrap);
+    void setJustifyContent(FlexJustify j);
+    void setAlignItems(FlexAlign a);
+
+    // Clip the children to the panel rect: scissor in draw() (rectangular,
+    // rounded corners are not clipped) and the GuiHitTest clip in update().
+    // Children entirely outside it are culled. Popups (menu dropdowns) are
+    // not clipped. Off by default.
+    void setClipChildren(bool clip) { m_clip_children = clip; }
+    bool clipChildren() const { return m_clip_children; }
+
+    // update() measures and places the children only when the panel's layout
+    // is dirty (see GuiElement::mark_layout_dirty), its rect changed or the
+    // framebuffer was resized, then
+    // updates them in order; draw() draws the panel and then its children.
+    // An off-screen panel skips its own quad; a clipping one also skips its
+    // children (layout included).
+    void update(float dt, GuiInputState& input) override;
+    void draw() const override;
 
 private:
     // Helpers
-    void draw_panel_quad(float x, float y, float w, float h);
-    void layout_children(float x, float y, float w, float h);
-    static bool ensure_gl_resources();
+    void draw_panel_quad(float x, float y, float w, float h) const;
+    void arrange_children(float x, float y, float w, float h);
+    void arrange_flex(float cx, float cy, float cw, float ch);
 
 private:
     std::vector<GuiElement*> m_children;
@@ -43,16 +73,31 @@ private:
     float m_padding = 8.0f;
     float m_spacing = 6.0f;
     LayoutType m_layout = LayoutType::HORIZONTAL;
+    FlexDirection m_flex_direction = FlexDirection::ROW;
+    bool m_flex_wrap = false;
+    FlexJustify m_justify = FlexJustify::START;
+    FlexAlign m_align_items = FlexAlign::STRETCH;
+    bool m_clip_children = false;
+    bool m_culled = false; // panel rect off screen / clipped out this frame
 
-    // Shared GL resources
-    static unsigned int s_vao;
-    static unsigned int s_vbo;
-    static unsigned int s_shader;
-    static int s_uProjLoc;
-    static int s_uRectMinLoc;
-    static int s_uRectMaxLoc;
-    static int s_uRadiusLoc;
-    static int s_uBgColorLoc;
-    static int s_uBorderColorLoc;
-    static int s_uBorderThicknessLoc;
+    // FLEX scratch, reused between layouts (main = along the direction)
+    struct FlexSlot {
+        GuiElement* child = nullptr;
+        float base = 0.0f;       // clamped preferred main size
+        float main = 0.0f;       // resolved main size
+        float cross = 0.0f;      // preferred cross size
+        float min_main = 0.0f, max_main = 0.0f;
+        float min_cross = 0.0f, max_cross = 0.0f;
+        float target = 0.0f;     // unclamped share of the current round
+        bool frozen = false;
+    };
+    struct FlexLine {
+        std::size_t begin = 0, end = 0; // slots
+        float cross = 0.0f;
+    };
+    std::vector<FlexSlot> m_flex_slots;
+    std::vector<FlexLine> m_flex_lines;
+    static void resolve_flex_line(FlexSlot* slots, std::size_t count, float space);
+    float m_laid_rect[4] = {0.f, 0.f, -1.f, -1.f}; // rect of the last arrange_children()
+    int m_laid_fb[2] = {0, 0}; // framebuffer size then (percent sizes, aligned children)
 };
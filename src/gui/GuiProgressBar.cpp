@@ -4,12 +4,12 @@
 #include "GuiDraw.h"
 
 #include <algorithm>
-#include <cstdio>
 #include <cmath>
 
 GuiProgressBar::GuiProgressBar()
 {
     m_text.set_text_size(3);
+    m_text.set_number_affixes("", "%");
 }
 
 void GuiProgressBar::set_progress(float percent)
@@ -36,34 +36,42 @@ std::pair<float,float> GuiProgressBar::preferred_size() const
     return {220.0f, 24.0f};
 }
 
-void GuiProgressBar::draw()
+void GuiProgressBar::update(float dt, GuiInputState& input)
 {
     if (!m_visible) return;
     float x = pixel_x();
     float y = pixel_y();
-    float w = pixel_w();
-    float h = pixel_h();
+    float w = box_w();
+    float h = box_h();
     if (w <= 0.0f || h <= 0.0f) {
         auto ps = preferred_size();
         if (w <= 0.0f) w = ps.first;
         if (h <= 0.0f) h = ps.second;
     }
-    if (w <= 0.0f || h <= 0.0f) return;
-
-    GuiDraw::draw_rounded_rect(x, y, w, h, 4.0f, m_bg);
-    float t = std::clamp(m_progress / 100.0f, 0.0f, 1.0f);
-    GuiDraw::draw_rounded_rect(x, y, w * t, h, 4.0f, m_bar);
+    m_rect = DrawRect{x, y, w, h, w > 0.0f && h > 0.0f};
+    if (!m_rect.valid) return;
+    if (culled(x, y, w, h)) { m_rect.valid = false; return; }
 
     if (m_show_text) {
-        char buf[32];
-        std::snprintf(buf, sizeof(buf), "%d%%", (int)std::round(m_progress));
-        m_text.set_text(buf);
+        m_text.set_number(m_progress, 0); // rewrites only the digits that changed
         float asc=0.0f, desc=0.0f;
         bool have = m_text.vertical_extents(asc, desc);
         float base_y = have ? (y + (h - (asc - desc)) * 0.5f + (asc - desc) * 0.6f)
                             : (y + (h - m_text.preferred_size().second) * 0.5f + m_text.preferred_size().second * 0.6f);
         float base_x = x + (w - m_text.preferred_size().first) * 0.5f;
         m_text.set_position(base_x, base_y, false);
-        m_text.draw();
+        m_text.update(dt, input);
     }
 }
+
+void GuiProgressBar::draw() const
+{
+    if (!m_visible || !m_rect.valid) return;
+    const float x = m_rect.x, y = m_rect.y, w = m_rect.w, h = m_rect.h;
+
+    GuiDraw::draw_rounded_rect(x, y, w, h, 4.0f, m_bg);
+    float t = std::clamp(m_progress / 100.0f, 0.0f, 1.0f);
+    GuiDraw::draw_rounded_rect(x, y, w * t, h, 4.0f, m_bar);
+
+    if (m_show_text) m_text.draw();
+}
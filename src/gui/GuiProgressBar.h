@@ -16,7 +16,8 @@ public:
     bool set_text_font(const std::string& path) { return m_text.set_text_font(path); }
     void set_text_size(int sz_1_to_10) { m_text.set_text_size(sz_1_to_10); }
 
-    void draw() override;
+    void update(float dt, GuiInputState& input) override;
+    void draw() const override;
     std::pair<float,float> preferred_size() const override;
 
 private:
@@ -0,0 +1,102 @@
+// GuiSdf.cpp - Implementation of the coverage to SDF conversion
+
+#include "GuiSdf.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr float kInf = 1e20f;
+
+// 1D squared distance transform (Felzenszwalb & Huttenlocher), in place on f[0..n)
+static void edt_1d(float* f, int n, int stride, std::vector<float>& d, std::vector<int>& v, std::vector<float>& z)
+{
+    int k = 0;
+    v[0] = 0;
+    z[0] = -kInf;
+    z[1] = kInf;
+    for (int q = 1; q < n; ++q) {
+        const float fq = f[q * stride] + static_cast<float>(q) * q;
+        float s;
+        for (;;) {
+            const int r = v[static_cast<size_t>(k)];
+            s = (fq - (f[r * stride] + static_cast<float>(r) * r)) / (2.0f * static_cast<float>(q - r));
+            if (s > z[static_cast<size_t>(k)]) break;
+            --k; // z[0] is -inf, so k never goes below 0
+        }
+        ++k;
+        v[static_cast<size_t>(k)] = q;
+        z[static_cast<size_t>(k)] = s;
+        z[static_cast<size_t>(k) + 1] = kInf;
+    }
+    k = 0;
+    for (int q = 0; q < n; ++q) {
+        while (z[static_cast<size_t>(k) + 1] < static_cast<float>(q)) ++k;
+        const int r = v[static_cast<size_t>(k)];
+        d[static_cast<size_t>(q)] = static_cast<float>(q - r) * (q - r) + f[r * stride];
+    }
+    for (int q = 0; q < n; ++q) f[q * stride] = d[static_cast<size_t>(q)];
+}
+
+// 2D squared distance transform: grid holds 0 on source pixels, kInf elsewhere
+static void edt_2d(std::vector<float>& grid, int w, int h)
+{
+    const int n = std::max(w, h);
+    std::vector<float> d(static_cast<size_t>(n));
+    std::vector<int> v(static_cast<size_t>(n));
+    std::vector<float> z(static_cast<size_t>(n) + 1);
+    for (int x = 0; x < w; ++x) edt_1d(&grid[static_cast<size_t>(x)], h, w, d, v, z);
+    for (int y = 0; y < h; ++y) edt_1d(&grid[static_cast<size_t>(y) * w], w, 1, d, v, z);
+}
+
+} // namespace
+
+namespace GuiSdf {
+
+void from_coverage(const unsigned char* coverage, int w, int h, int pitch, int spread,
+                   std::vector<unsigned char>& out, int& out_w, int& out_h)
+{
+    if (spread < 1) spread = 1;
+    out_w = std::max(w, 0) + 2 * spread;
+    out_h = std::max(h, 0) + 2 * spread;
+    const size_t count = static_cast<size_t>(out_w) * static_cast<size_t>(out_h);
+
+    // Padded coverage in [0,1]
+    std::vector<float> cov(count, 0.0f);
+    for (int y = 0; y < h; ++y) {
+        const unsigned char* row = coverage + static_cast<std::ptrdiff_t>(y) * pitch;
+        for (int x = 0; x < w; ++x) {
+            cov[static_cast<size_t>(y + spread) * out_w + static_cast<size_t>(x + spread)] = row[x] / 255.0f;
+        }
+    }
+
+    // Distance of outside pixels to the shape, and of inside pixels to the background
+    std::vector<float> to_inside(count), to_outside(count);
+    for (size_t i = 0; i < count; ++i) {
+        const bool inside = cov[i] >= 0.5f;
+        to_inside[i] = inside ? 0.0f : kInf;
+        to_outside[i] = inside ? kInf : 0.0f;
+    }
+    edt_2d(to_inside, out_w, out_h);
+    edt_2d(to_outside, out_w, out_h);
+
+    out.resize(count);
+    const float scale = 127.0f / static_cast<float>(spread);
+    for (size_t i = 0; i < count; ++i) {
+        float dist;
+        const float c = cov[i];
+        if (c > 0.0f && c < 1.0f) {
+            // Anti-aliased edge pixel: coverage is a good sub-pixel estimate
+            dist = c - 0.5f;
+        } else if (c >= 0.5f) {
+            dist = std::sqrt(to_outside[i]) - 0.5f;  // edge lies half-way to the nearest outside pixel
+        } else {
+            dist = 0.5f - std::sqrt(to_inside[i]);
+        }
+        const float value = 128.0f + dist * scale;
+        out[i] = static_cast<unsigned char>(std::min(255.0f, std::max(0.0f, value + 0.5f)));
+    }
+}
+
+} // namespace GuiSdf
@@ -0,0 +1,23 @@
+// GuiSdf.h - Signed distance field generation from 8-bit coverage bitmaps
+#pragma once
+
+#include <vector>
+
+namespace GuiSdf {
+
+// SDF glyph atlases (GuiText, mge_fontbake) are rasterized once at this pixel
+// size, with this spread in pixels
+constexpr int kGlyphBasePx = 48;
+constexpr int kGlyphSpread = 6;
+
+// Convert a w x h coverage bitmap (rows `pitch` bytes apart) into a signed
+// distance field padded by `spread` pixels on every side.
+// Output is (w + 2*spread) x (h + 2*spread), tightly packed, and uses the
+// FreeType FT_RENDER_MODE_SDF encoding: 128 on the outline, larger inside,
+// value = 128 + distance / spread * 127 (clamped).
+// Distances come from an exact Euclidean distance transform of the 50%
+// coverage mask, refined with the coverage of anti-aliased edge pixels.
+void from_coverage(const unsigned char* coverage, int w, int h, int pitch, int spread,
+                   std::vector<unsigned char>& out, int& out_w, int& out_h);
+
+} // namespace GuiSdf
@@ -38,11 +38,6 @@ void GuiSlider::set_colors(float bg_r, float bg_g, float bg_b, float bg_a,
     m_colors_knob[0]=knob_r; m_colors_knob[1]=knob_g; m_colors_knob[2]=knob_b; m_colors_knob[3]=knob_a;
 }
 
-bool GuiSlider::hit_test(float px, float py, float x, float y, float w, float h) const
-{
-    return (px >= x && px <= x + w && py >= y && py <= y + h);
-}
-
 std::pair<float,float> GuiSlider::preferred_size() const
 {
     if (m_size_w > 0.0f && m_size_h > 0.0f) return {pixel_w(), pixel_h()};
@@ -52,42 +47,52 @@ std::pair<float,float> GuiSlider::preferred_size() const
         return {24.0f, 120.0f};
 }
 
-void GuiSlider::draw()
+void GuiSlider::update(float /*dt*/, GuiInputState& input)
 {
     if (!m_visible) return;
 
     float x = pixel_x();
     float y = pixel_y();
-    float w = pixel_w();
-    float h = pixel_h();
+    float w = box_w();
+    float h = box_h();
     if (w <= 0.0f || h <= 0.0f) {
         auto ps = preferred_size();
         if (w <= 0.0f) w = ps.first;
         if (h <= 0.0f) h = ps.second;
     }
-    if (w <= 0.0f || h <= 0.0f) return;
+    m_rect = DrawRect{x, y, w, h, w > 0.0f && h > 0.0f};
+    if (!m_rect.valid) return;
+    if (culled(x, y, w, h)) { m_rect.valid = false; m_dragging = false; return; }
 
-    const auto [mx, my] = GuiInput::mouse_pos_px();
-    const bool hovered = hit_test(static_cast<float>(mx), static_cast<float>(my), x, y, w, h);
+    const float mx = static_cast<float>(input.mouse_x);
+    const float my = static_cast<float>(input.mouse_y);
+    add_hit_rect(x, y, w, h);
+    const bool hovered = input.hover == this;
 
     // Dragging logic
-    if (GuiInput::left_clicked() && hovered) {
+    if (input.left_clicked && hovered) {
         m_dragging = true;
     }
-    if (!GuiInput::left_down()) {
+    if (!input.left_down) {
         m_dragging = false;
     }
     if (m_dragging) {
         if (m_orientation == Orientation::Horizontal) {
-            float t = (static_cast<float>(mx) - x) / std::max(1.0f, w);
+            float t = (mx - x) / std::max(1.0f, w);
             t = std::clamp(t, 0.0f, 1.0f);
             set_value(m_min + t * (m_max - m_min));
         } else {
-            float t = (static_cast<float>(my) - y) / std::max(1.0f, h);
+            float t = (my - y) / std::max(1.0f, h);
             t = std::clamp(t, 0.0f, 1.0f);
             set_value(m_min + t * (m_max - m_min));
         }
     }
+}
+
+void GuiSlider::draw() const
+{
+    if (!m_visible || !m_rect.valid) return;
+    const float x = m_rect.x, y = m_rect.y, w = m_rect.w, h = m_rect.h;
 
     // Draw track
     GuiDraw::draw_rounded_rect(x, y, w, h, m_radius, m_colors_bg);
@@ -13,7 +13,7 @@ public:
     void set_range(float mn, float mx);
     void set_value(float v);
     float get_value() const { return m_value; }
-    void set_orientation(Orientation o) { m_orientation = o; }
+    void set_orientation(Orientation o) { m_orientation = o; mark_layout_dirty(); }
 
     virtual void onValueChanged();
     void set_on_value_changed(std::function<void(float)> cb) { m_on_changed = std::move(cb); }
@@ -24,12 +24,10 @@ public:
                     float knob_r, float knob_g, float knob_b, float knob_a);
     void set_corner_radius(float r) { m_radius = (r < 0.f ? 0.f : r); }
 
-    void draw() override;
+    void update(float dt, GuiInputState& input) override;
+    void draw() const override;
     std::pair<float,float> preferred_size() const override;
 
-private:
-    bool hit_test(float px, float py, float x, float y, float w, float h) const;
-
 private:
     float m_min = 0.0f;
     float m_max = 100.0f;
@@ -0,0 +1,162 @@
+// GuiStreamBuffer.cpp - Implementation of the shared streaming ring buffer
+
+#include "GuiStreamBuffer.h"
+#include "GuiGlState.h"
+
+#include <cstring>
+#include <cstdio>
+
+GuiStreamBuffer& GuiStreamBuffer::instance()
+{
+    static GuiStreamBuffer inst;
+    return inst;
+}
+
+bool GuiStreamBuffer::ensure_buffer()
+{
+    if (m_buffer != 0) return true;
+
+    m_capacity = m_requested_capacity;
+    glGenBuffers(1, &m_buffer);
+    GuiGlState::bind_array_buffer(m_buffer);
+
+    // The loader is generated for GL 3.3: glBufferStorage only comes from
+    // ARB_buffer_storage, whatever version the context reports
+    const bool has_storage = GLAD_GL_ARB_buffer_storage && glBufferStorage != nullptr;
+    if (has_storage) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(m_capacity), nullptr, flags);
+        m_mapped = static_cast<unsigned char*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(m_capacity), flags));
+        if (!m_mapped) {
+            // Immutable storage cannot be respecified: recreate for the orphaning path
+            std::fprintf(stderr, "[GuiStreamBuffer] Persistent mapping failed, using buffer orphaning.\n");
+            GuiGlState::forget_buffer(m_buffer);
+            glDeleteBuffers(1, &m_buffer);
+            glGenBuffers(1, &m_buffer);
+            GuiGlState::bind_array_buffer(m_buffer);
+        }
+    }
+    if (!m_mapped) {
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(m_capacity), nullptr, GL_STREAM_DRAW);
+    }
+    m_head = 0;
+    m_segment_begin = 0;
+    return m_buffer != 0;
+}
+
+void GuiStreamBuffer::destroy_buffer()
+{
+    for (auto& s : m_segments) glDeleteSync(s.sync);
+    m_segments.clear();
+    if (m_buffer) {
+        if (m_mapped) {
+            GuiGlState::bind_array_buffer(m_buffer);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+            m_mapped = nullptr;
+        }
+        GuiGlState::forget_buffer(m_buffer);
+        glDeleteBuffers(1, &m_buffer);
+        m_buffer = 0;
+    }
+    m_capacity = 0;
+    m_head = 0;
+    m_segment_begin = 0;
+}
+
+void GuiStreamBuffer::begin_frame()
+{
+    m_last = m_cur;
+    m_cur = Stats{};
+    if (m_grow_pending) {
+        // Last frame did not fit: double the ring so steady state never waits
+        m_grow_pending = false;
+        if (m_requested_capacity <= m_capacity) m_requested_capacity = m_capacity * 2;
+        destroy_buffer();
+    }
+}
+
+void GuiStreamBuffer::wait_for_range(std::size_t begin, std::size_t end)
+{
+    // Newest fenced segment overlapping [begin,end); fences signal in order,
+    // so waiting on it retires every older segment as well.
+    int last = -1;
+    for (int i = 0; i < static_cast<int>(m_segments.size()); ++i) {
+        const Segment& s = m_segments[static_cast<size_t>(i)];
+        if (s.begin < end && begin < s.end) last = i;
+    }
+    if (last < 0) return;
+
+    GLsync sync = m_segments[static_cast<size_t>(last)].sync;
+    GLenum r = glClientWaitSync(sync, 0, 0);
+    if (r == GL_TIMEOUT_EXPIRED) {
+        m_cur.stalls += 1;
+        do {
+            r = glClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1 ms slices
+        } while (r == GL_TIMEOUT_EXPIRED);
+    }
+    for (int i = 0; i <= last; ++i) {
+        glDeleteSync(m_segments.front().sync);
+        m_segments.pop_front();
+    }
+}
+
+GLintptr GuiStreamBuffer::upload(const void* data, std::size_t bytes, std::size_t alignment)
+{
+    if (bytes == 0) return -1;
+    if (bytes > m_requested_capacity) {
+        // A single upload larger than the ring: grow right away
+        std::size_t cap = m_requested_capacity;
+        while (cap < bytes) cap *= 2;
+        m_requested_capacity = cap;
+        destroy_buffer();
+    }
+    if (!ensure_buffer()) return -1;
+    GuiGlState::bind_array_buffer(m_buffer);
+
+    if (alignment == 0) alignment = 1;
+    std::size_t offset = (m_head + alignment - 1) / alignment * alignment;
+    if (offset + bytes > m_capacity) {
+        offset = 0;
+        m_cur.wraps += 1;
+        if (m_mapped) {
+            // Data of the current frame may lie ahead of us: fence it so the
+            // overlap test below covers it, and grow next frame.
+            if (m_head > m_segment_begin) { fence(); m_grow_pending = true; }
+        } else {
+            // Orphan: the driver hands us fresh storage, in-flight draws keep the old one
+            glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(m_capacity), nullptr, GL_STREAM_DRAW);
+        }
+        m_segment_begin = 0;
+    }
+
+    if (m_mapped) {
+        wait_for_range(offset, offset + bytes);
+        std::memcpy(m_mapped + offset, data, bytes);
+    } else {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+        void* dst = glMapBufferRange(GL_ARRAY_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(bytes), flags);
+        if (dst) {
+            std::memcpy(dst, data, bytes);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+        } else {
+            glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(bytes), data);
+        }
+    }
+
+    m_head = offset + bytes;
+    m_cur.bytes_uploaded += bytes;
+    m_cur.uploads += 1;
+    return static_cast<GLintptr>(offset);
+}
+
+void GuiStreamBuffer::fence()
+{
+    if (!m_mapped) { m_segment_begin = m_head; return; } // orphaning needs no fences
+    if (m_head <= m_segment_begin) return;
+    Segment s;
+    s.begin = m_segment_begin;
+    s.end = m_head;
+    s.sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_segments.push_back(s);
+    m_segment_begin = m_head;
+}
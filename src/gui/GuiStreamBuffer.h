@@ -0,0 +1,67 @@
+// GuiStreamBuffer.h - Shared streaming ring buffer for per-frame 2D geometry
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <glad/glad.h>
+
+// One GL buffer that every per-frame GUI upload goes through.
+// - With ARB_buffer_storage the buffer is persistently mapped and
+//   written directly; each flushed range is protected by a fence that is only
+//   waited on when the ring wraps onto it.
+// - On plain GL 3.3 the buffer is orphaned on wrap-around and ranges are
+//   written with unsynchronized mappings, so the driver never has to sync.
+class GuiStreamBuffer {
+public:
+    static GuiStreamBuffer& instance();
+
+    // Counters for one frame (begin_frame() to begin_frame())
+    struct Stats {
+        std::size_t bytes_uploaded = 0;
+        int uploads = 0;
+        int wraps = 0;     // times the write head went back to offset 0
+        int stalls = 0;    // wraps that had to wait on a fence still in flight
+    };
+
+    // Requested size of the ring in bytes; applied on next (re)creation.
+    void set_capacity(std::size_t bytes) { m_requested_capacity = bytes; }
+
+    // Roll per-frame counters. Grows the ring if last frame overran it.
+    void begin_frame();
+    // Copy `bytes` into the ring and return the byte offset of the copy inside
+    // buffer(), or -1 on failure. Leaves buffer() bound to GL_ARRAY_BUFFER.
+    GLintptr upload(const void* data, std::size_t bytes, std::size_t alignment = 16);
+    // Fence everything written since the previous fence (call after the draws
+    // that read it have been issued).
+    void fence();
+
+    GLuint buffer() const { return m_buffer; }
+    bool persistent() const { return m_mapped != nullptr; }
+    std::size_t capacity() const { return m_capacity; }
+    const Stats& frame_stats() const { return m_last; }   // last completed frame
+    const Stats& current_stats() const { return m_cur; }  // frame in progress
+
+private:
+    GuiStreamBuffer() = default;
+    bool ensure_buffer();
+    void destroy_buffer();
+    void wait_for_range(std::size_t begin, std::size_t end);
+
+    struct Segment {
+        std::size_t begin = 0;
+        std::size_t end = 0;
+        GLsync sync = nullptr;
+    };
+
+    GLuint m_buffer = 0;
+    unsigned char* m_mapped = nullptr; // persistent mapping (nullptr => orphaning path)
+    std::size_t m_capacity = 0;
+    std::size_t m_requested_capacity = 4u * 1024u * 1024u;
+    std::size_t m_head = 0;
+    std::size_t m_segment_begin = 0; // start of the range not fenced yet
+    bool m_grow_pending = false;
+    std::deque<Segment> m_segments;  // fenced ranges still possibly in use, oldest first
+
+    Stats m_cur{};
+    Stats m_last{};
+};
@@ -1,98 +1,274 @@
 // GuiText.cpp - Implementation of GuiText using FreeType and OpenGL
 
 #include "GuiText.h"
+#include "GuiDraw.h"
+#include "GuiFrameContext.h"
+#include "GuiGlyphAtlas.h"
+#include "GuiGlyphRasterizer.h"
+#include "GuiFontBake.h"
+#include "GuiSdf.h"
 
 #include <glad/glad.h>
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
+#include FT_OUTLINE_H
 
 #include <vector>
 #include <cstdio>
 #include <cstdint>
 #include <cmath>
 #include <algorithm>
+#include <cstring>
 
 // Static storage
-std::unordered_map<GuiText::FontKey, GuiText::GlyphMap, GuiText::FontKeyHash> GuiText::s_glyph_cache;
-unsigned int GuiText::s_vao = 0;
-unsigned int GuiText::s_vbo = 0;
-unsigned int GuiText::s_shader = 0;
-int GuiText::s_uProjLoc = -1;
-int GuiText::s_uTextColorLoc = -1;
-void* GuiText::s_ft_library = nullptr; // FT_Library
-int GuiText::s_fb_width = 0;
-int GuiText::s_fb_height = 0;
+std::unordered_map<GuiText::FontKey, GuiText::FontData, GuiText::FontKeyHash> GuiText::s_glyph_cache;
+std::unordered_map<FontId, GuiKerning> GuiText::s_kerning;
+std::unordered_map<FontId, GuiText::FontFallback> GuiText::s_fallbacks;
+std::vector<FontId> GuiText::s_default_fallbacks;
+bool GuiText::s_sdf_default = false;
+std::size_t GuiText::s_glyph_budget = 4u * 1024u * 1024u; // 2048x2048 R8 per font
+bool GuiText::s_async_glyphs = true;
+std::size_t GuiText::s_upload_budget = 64u * 1024u;         // bitmap bytes uploaded per frame
+unsigned long GuiText::s_upload_frame = ~0ul;
+std::vector<GuiText*> GuiText::s_frame_texts;
 
 namespace {
 
-// Simple orthographic projection matrix, origin at bottom-left, z range [-1,1]
-static void make_ortho(float left, float right, float bottom, float top, float znear, float zfar, float out[16])
+// Decode the UTF-8 sequence at s[i] and advance i. Malformed bytes are skipped
+// (returns false) so a truncated string never emits garbage glyphs.
+static bool next_codepoint(const std::string& s, std::size_t& i, unsigned long& cp)
 {
-    for (int i=0;i<16;++i) out[i] = 0.0f;
-    out[0] = 2.0f / (right - left);
-    out[5] = 2.0f / (top - bottom);
-    out[10] = -2.0f / (zfar - znear);
-    out[12] = - (right + left) / (right - left);
-    out[13] = - (top + bottom) / (top - bottom);
-    out[14] = - (zfar + znear) / (zfar - znear);
-    out[15] = 1.0f;
+    const unsigned char c0 = static_cast<unsigned char>(s[i++]);
+    if (c0 < 0x80) { cp = c0; return true; }
+    int extra = 0;
+    if ((c0 & 0xE0) == 0xC0) { cp = c0 & 0x1F; extra = 1; }
+    else if ((c0 & 0xF0) == 0xE0) { cp = c0 & 0x0F; extra = 2; }
+    else if ((c0 & 0xF8) == 0xF0) { cp = c0 & 0x07; extra = 3; }
+    else return false;
+    for (int k = 0; k < extra; ++k) {
+        if (i >= s.size()) return false;
+        const unsigned char c = static_cast<unsigned char>(s[i]);
+        if ((c & 0xC0) != 0x80) return false;
+        cp = (cp << 6) | (c & 0x3F);
+        ++i;
+    }
+    return true;
 }
 
-static unsigned int compile_shader(GLenum type, const char* src)
+// Largest power-of-two atlas side whose area fits the budget
+static int atlas_side_for_budget(std::size_t bytes)
 {
-    GLuint sh = glCreateShader(type);
-    glShaderSource(sh, 1, &src, nullptr);
-    glCompileShader(sh);
-    GLint ok = GL_FALSE;
-    glGetShaderiv(sh, GL_COMPILE_STATUS, &ok);
-    if (!ok) {
-        GLint len = 0; glGetShaderiv(sh, GL_INFO_LOG_LENGTH, &len);
-        std::string log(len > 0 ? len : 1, '\0');
-        glGetShaderInfoLog(sh, len, nullptr, log.data());
-        std::fprintf(stderr, "[GuiText] Shader compile error (%s):\n%s\n", type==GL_VERTEX_SHADER?"VERTEX":"FRAGMENT", log.c_str());
-        glDeleteShader(sh);
-        return 0;
+    int side = 256;
+    while (static_cast<std::size_t>(side) * 2u * static_cast<std::size_t>(side) * 2u <= bytes && side < 8192) side *= 2;
+    return side;
+}
+
+// Characters set_number() can produce; their glyphs are resolved per layout
+constexpr char kNumberChars[] = "0123456789-.";
+
+static int number_glyph_index(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    return c == '-' ? 10 : 11;
+}
+
+// Fixed-point decimal text of `value` ("-12.50"): no allocation, no locale.
+// Rounds like printf("%.*f") but writes "-0" as "0". Returns the length.
+static int format_number(double value, int decimals, char* out)
+{
+    static const double kPow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9};
+    const double p = kPow10[decimals];
+    const double r = value * p;
+    double scaled = std::round(r);
+    if (std::fabs(r - std::trunc(r)) == 0.5) {
+        // r is the product rounded to a double: its exact error breaks the
+        // tie (above or below the half, half-to-even when exact)
+        const double err = std::fma(value, p, -r);
+        const double down = std::trunc(r);
+        const bool away = (err != 0.0) ? ((err > 0.0) == (r > 0.0)) : (std::fmod(down, 2.0) != 0.0);
+        if (!away) scaled = down;
+    }
+    if (!(std::fabs(scaled) < 1e18)) { // NaN, infinity, beyond long long
+        out[0] = '-'; out[1] = '-';
+        return 2;
+    }
+    const long long n = static_cast<long long>(scaled);
+    unsigned long long u = n < 0 ? 0ull - static_cast<unsigned long long>(n) : static_cast<unsigned long long>(n);
+    char digits[24];
+    int count = 0;
+    do {
+        digits[count++] = static_cast<char>('0' + u % 10u);
+        u /= 10u;
+    } while (u != 0 || count <= decimals); // at least one digit before the point
+    int len = 0;
+    if (n < 0) out[len++] = '-';
+    for (int k = count - 1; k >= 0; --k) {
+        out[len++] = digits[k];
+        if (k == decimals && decimals > 0) out[len++] = '.';
     }
-    return sh;
+    return len;
 }
 
-static unsigned int link_program(GLuint vs, GLuint fs)
+static float advance_px(const GuiGlyph& g, bool sdf)
 {
-    GLuint p = glCreateProgram();
-    glAttachShader(p, vs);
-    glAttachShader(p, fs);
-    glLinkProgram(p);
-    GLint ok = GL_FALSE;
-    glGetProgramiv(p, GL_LINK_STATUS, &ok);
-    if (!ok) {
-        GLint len = 0; glGetProgramiv(p, GL_INFO_LOG_LENGTH, &len);
-        std::string log(len > 0 ? len : 1, '\0');
-        glGetProgramInfoLog(p, len, nullptr, log.data());
-        std::fprintf(stderr, "[GuiText] Program link error:\n%s\n", log.c_str());
-        glDeleteProgram(p);
-        return 0;
+    return sdf ? static_cast<float>(g.advance) / 64.0f : static_cast<float>(g.advance >> 6);
+}
+
+// Replace v[at, at + count) with `with`: the elements after the range are
+// moved once (memmove for these types), not rebuilt
+template <class T>
+static void splice_range(std::vector<T>& v, std::size_t at, std::size_t count, const std::vector<T>& with)
+{
+    const std::size_t common = std::min(count, with.size());
+    std::copy(with.begin(), with.begin() + static_cast<std::ptrdiff_t>(common), v.begin() + static_cast<std::ptrdiff_t>(at));
+    if (with.size() > count) {
+        v.insert(v.begin() + static_cast<std::ptrdiff_t>(at + common), with.begin() + static_cast<std::ptrdiff_t>(common), with.end());
+    } else if (count > with.size()) {
+        v.erase(v.begin() + static_cast<std::ptrdiff_t>(at + common), v.begin() + static_cast<std::ptrdiff_t>(at + count));
     }
-    return p;
+}
+
+// Quad of `g` with its pen at `pen_x` (raster pixels), zero-sized when blank
+static GuiDraw::GlyphQuad glyph_quad(const GuiGlyph* g, float pen_x, float baseline_y, float scale)
+{
+    GuiDraw::GlyphQuad q{};
+    if (!g || g->pending || g->width <= 0 || g->height <= 0) return q;
+    q.x0 = pen_x * scale + static_cast<float>(g->bearing_x) * scale;
+    q.y0 = baseline_y - static_cast<float>(g->height - g->bearing_y) * scale;
+    q.x1 = q.x0 + static_cast<float>(g->width) * scale;
+    q.y1 = q.y0 + static_cast<float>(g->height) * scale;
+    q.u0 = g->u0; q.v0 = g->v0; q.u1 = g->u1; q.v1 = g->v1;
+    return q;
 }
 
 } // namespace
 
-GuiText::GuiText() { /* lazy init in draw */ }
-GuiText::~GuiText() { /* glyph cache persists for process lifetime */ }
+GuiText::GuiText() { /* laid out once a font and a text are set */ }
+
+GuiText::~GuiText()
+{
+    // Glyph cache persists for process lifetime; only the frame list refers to this text
+    if (m_finalize_frame == GuiDraw::frame_index()) {
+        s_frame_texts.erase(std::remove(s_frame_texts.begin(), s_frame_texts.end(), this), s_frame_texts.end());
+    }
+}
 
 void GuiText::set_position(float x, float y, bool in_percentage) {
     GuiElement::set_position(x, y, in_percentage);
 }
 
 void GuiText::set_text(const std::string& str) {
+    if (m_number.active) {
+        // Leaving number mode: laid out from scratch
+        m_number.active = false;
+        m_text = str;
+        invalidate_layout();
+        relayout();
+        return;
+    }
+    if (m_text == str) return; // keep the cached run
+    mark_layout_dirty();
+    if (m_para.valid) {
+        // Bytes kept at both ends since the last layout bound the reflow
+        const std::size_t common = std::min(m_text.size(), str.size());
+        std::size_t prefix = 0;
+        while (prefix < common && m_text[prefix] == str[prefix]) ++prefix;
+        std::size_t suffix = 0;
+        while (suffix < common - prefix && m_text[m_text.size() - 1 - suffix] == str[str.size() - 1 - suffix]) ++suffix;
+        m_para.clean_prefix = std::min(m_para.clean_prefix, prefix);
+        m_para.clean_suffix = std::min(m_para.clean_suffix, suffix);
+    }
     m_text = str;
+    invalidate_run();
+    relayout();
+}
+
+void GuiText::append_text(const std::string& str) {
+    if (str.empty()) return;
+    if (m_number.active) { set_text(m_text + str); return; }
+    m_para.clean_prefix = std::min(m_para.clean_prefix, m_text.size());
+    m_para.clean_suffix = 0;
+    m_text += str;
+    invalidate_run();
+    mark_layout_dirty();
+    relayout();
+}
+
+void GuiText::set_number(double value, int decimals) {
+    decimals = std::clamp(decimals, 0, 9);
+    char buf[kMaxNumberChars];
+    const int len = format_number(value, decimals, buf);
+    NumberCache& num = m_number;
+    if (num.active && num.len == len && std::memcmp(num.text, buf, static_cast<std::size_t>(len)) == 0) return;
+    if (!num.active) {
+        num.active = true;
+        invalidate_layout();
+    }
+    // Digits replacing digits keep the width: containers keep their layout
+    bool resized = num.len != len;
+    for (int k = 0; k < len && !resized; ++k) {
+        const bool digit = buf[k] >= '0' && buf[k] <= '9';
+        const bool was_digit = num.text[k] >= '0' && num.text[k] <= '9';
+        resized = (buf[k] != num.text[k]) && !(digit && was_digit);
+    }
+    if (resized) mark_layout_dirty();
+    std::memcpy(num.text, buf, static_cast<std::size_t>(len));
+    num.len = len;
+    // Same capacity every time: no allocation once the label has been shown
+    m_text.assign(num.prefix).append(buf, static_cast<std::size_t>(len)).append(num.suffix);
+    invalidate_run();
+    relayout();
+}
+
+void GuiText::set_number_affixes(const std::string& prefix, const std::string& suffix) {
+    NumberCache& num = m_number;
+    if (num.prefix == prefix && num.suffix == suffix) return;
+    num.prefix = prefix;
+    num.suffix = suffix;
+    num.laid = false;
+    mark_layout_dirty();
+    if (num.active) {
+        m_text.assign(num.prefix).append(num.text, static_cast<std::size_t>(num.len)).append(num.suffix);
+        invalidate_run();
+    }
+    relayout();
+}
+
+void GuiText::set_wrap_width(float width_px) {
+    if (width_px < 0.0f) width_px = 0.0f;
+    if (m_wrap_width == width_px) return;
+    m_wrap_width = width_px;
+    invalidate_layout();
+    relayout();
+}
+
+void GuiText::set_text_align(TextAlign align) {
+    if (m_align == align) return;
+    m_align = align;
+    m_para.quads_dirty = true;
+    invalidate_run();
+    relayout();
+}
+
+void GuiText::set_line_spacing(float factor) {
+    if (factor <= 0.0f) factor = 1.0f;
+    if (m_line_spacing == factor) return;
+    m_line_spacing = factor;
+    m_para.quads_dirty = true;
+    invalidate_run();
+    mark_layout_dirty();
+    relayout();
 }
 
 bool GuiText::set_text_font(const std::string& font_path) {
     m_font_path = font_path;
-    m_font_ready = false; // will load lazily on next draw or preferred_size
-    return true;
+    // Mapped and parsed once per file; glyphs load with the text
+    m_font_id = font_path.empty() ? kInvalidFontId : GuiFontRegistry::instance().load(font_path);
+    m_font_ready = false;
+    invalidate_layout();
+    relayout();
+    return m_font_id != kInvalidFontId;
 }
 
 void GuiText::set_text_size(int size_1_to_10) {
@@ -101,86 +277,30 @@ void GuiText::set_text_size(int size_1_to_10) {
     if (m_size_level != size_1_to_10) {
         m_size_level = size_1_to_10;
         m_font_ready = false; // pixel size changed: refresh glyphs
+        invalidate_layout();
+        relayout();
     }
 }
 
+void GuiText::set_text_sdf(bool enabled) {
+    if (m_sdf == enabled) return;
+    m_sdf = enabled;
+    m_font_ready = false;
+    invalidate_layout();
+    relayout();
+}
+
 void GuiText::set_text_color(float r, float g, float b, float a) {
     m_color[0]=r; m_color[1]=g; m_color[2]=b; m_color[3]=a;
 }
 
-void GuiText::show() { m_visible = true; }
-void GuiText::hide() { m_visible = false; }
-
-void GuiText::on_framebuffer_resized(int fb_width, int fb_height) {
-    s_fb_width = fb_width;
-    s_fb_height = fb_height;
-}
+void GuiText::show() { GuiElement::show(); }
+void GuiText::hide() { GuiElement::hide(); }
 
 bool GuiText::init_renderer()
 {
-    if (s_shader != 0 && s_vao != 0 && s_vbo != 0 && s_ft_library != nullptr) return true;
-
-    // Init FreeType
-    if (!s_ft_library) {
-        FT_Library lib = nullptr;
-        if (FT_Init_FreeType(&lib) != 0) {
-            std::fprintf(stderr, "[GuiText] FreeType init failed.\n");
-            return false;
-        }
-        s_ft_library = lib;
-    }
-
-    // GL objects
-    if (s_vao == 0) {
-        glGenVertexArrays(1, &s_vao);
-        glBindVertexArray(s_vao);
-        glGenBuffers(1, &s_vbo);
-        glBindBuffer(GL_ARRAY_BUFFER, s_vbo);
-        // dynamic buffer for quads: each vertex = 4 floats (x,y,u,v)
-        glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, nullptr, GL_DYNAMIC_DRAW);
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-        glBindVertexArray(0);
-    }
-
-    if (s_shader == 0) {
-        static const char* VERT = R"GLSL(
-            #version 330 core
-            layout(location = 0) in vec4 aPosUV; // x,y,u,v
-            uniform mat4 uProjection;
-            out vec2 vUV;
-            void main() {
-                vUV = aPosUV.zw;
-                gl_Position = uProjection * vec4(aPosUV.xy, 0.0, 1.0);
-            }
-        )GLSL";
-        static const char* FRAG = R"GLSL(
-            #version 330 core
-            in vec2 vUV;
-            out vec4 FragColor;
-            uniform sampler2D uTex;
-            uniform vec4 uTextColor;
-            void main() {
-                float a = texture(uTex, vUV).r; // glyph stored in RED
-                FragColor = vec4(uTextColor.rgb, uTextColor.a * a);
-            }
-        )GLSL";
-
-        GLuint vs = compile_shader(GL_VERTEX_SHADER, VERT);
-        GLuint fs = compile_shader(GL_FRAGMENT_SHADER, FRAG);
-        if (!vs || !fs) return false;
-        s_shader = link_program(vs, fs);
-        glDeleteShader(vs);
-        glDeleteShader(fs);
-        if (!s_shader) return false;
-        s_uProjLoc = glGetUniformLocation(s_shader, "uProjection");
-        s_uTextColorLoc = glGetUniformLocation(s_shader, "uTextColor");
-        int uTexLoc = glGetUniformLocation(s_shader, "uTex");
-        glUseProgram(s_shader);
-        if (uTexLoc >= 0) glUniform1i(uTexLoc, 0);
-        glUseProgram(0);
-    }
-    return true;
+    // FreeType is owned by the font registry (GL drawing goes through GuiDraw)
+    return GuiFontRegistry::instance().library() != nullptr;
 }
 
 void GuiText::shutdown_renderer()
@@ -188,215 +308,1110 @@ void GuiText::shutdown_renderer()
     // Not used; kept for completeness if later needed.
 }
 
-int GuiText::pixel_size_for_level() const
+int GuiText::pixel_size(int size_1_to_10)
 {
+    if (size_1_to_10 < 1) size_1_to_10 = 1;
+    if (size_1_to_10 > 10) size_1_to_10 = 10;
     const int base = 18;
     const int step = 6;
-    return base + (m_size_level - 1) * step; // 18,24,30,...,72
+    return base + (size_1_to_10 - 1) * step; // 18,24,30,...,72
+}
+
+int GuiText::pixel_size_for_level() const
+{
+    return pixel_size(m_size_level);
 }
 
 float GuiText::pixel_x_from_pos() const {
-    if (m_pos_is_percent) return (s_fb_width > 0 ? (m_pos_x * 0.01f * s_fb_width) : m_pos_x);
+    const int fb_w = GuiFrameContext::current().fb_width;
+    if (m_pos_is_percent) return (fb_w > 0 ? (m_pos_x * 0.01f * fb_w) : m_pos_x);
     return m_pos_x;
 }
 
 float GuiText::pixel_y_from_pos() const {
-    if (m_pos_is_percent) return (s_fb_height > 0 ? (m_pos_y * 0.01f * s_fb_height) : m_pos_y);
+    const int fb_h = GuiFrameContext::current().fb_height;
+    if (m_pos_is_percent) return (fb_h > 0 ? (m_pos_y * 0.01f * fb_h) : m_pos_y);
     return m_pos_y;
 }
 
-bool GuiText::ensure_font_loaded() const
+GuiText::FontKey GuiText::font_key() const
+{
+    if (m_sdf) return FontKey{m_font_id, kSdfBasePx, true};
+    return FontKey{m_font_id, pixel_size_for_level(), false};
+}
+
+GuiText::FontData* GuiText::font_data() const
+{
+    if (!m_font_ready) return nullptr;
+    auto it = s_glyph_cache.find(font_key());
+    return it != s_glyph_cache.end() ? &it->second : nullptr;
+}
+
+void GuiText::relayout()
+{
+    // Before set_text_font() there is nothing to lay out (and nothing to report)
+    if (m_font_path.empty()) return;
+    // The font alone is enough for measure_text()
+    if (ensure_font_loaded()) layout_run();
+}
+
+bool GuiText::ensure_font_loaded()
 {
     if (m_font_ready) return true;
     if (m_font_path.empty()) {
         std::fprintf(stderr, "[GuiText] No font path set. Call set_text_font().\n");
         return false;
     }
-    if (!init_renderer()) return false;
+    if (m_font_id == kInvalidFontId) return false; // reported by GuiFontRegistry::load
 
-    const int px = pixel_size_for_level();
-    FontKey key{m_font_path, px};
+    FontKey key = font_key();
+    const int px = key.pixel_size;
     auto it = s_glyph_cache.find(key);
     if (it != s_glyph_cache.end()) {
-        m_font_ready = true;
+        m_font_ready = true; // loaded earlier or baked: no FreeType needed yet
         return true;
     }
+    if (!init_renderer()) return false;
+
+    // The face is shared per file; this pixel size gets its own FT_Size
+    if (!GuiFontRegistry::instance().activate(m_font_id, px)) return false;
+
+    FontData font;
+    font.font_id = m_font_id;
+    font.atlas.reset(new GuiGlyphAtlas(256, atlas_side_for_budget(s_glyph_budget)));
+    // Text already recorded this frame must be drawn before glyphs move
+    font.atlas->set_relayout_hook(&GuiDraw::submit);
+    font.sdf = key.sdf;
+    font.raster_px = px;
+    font.glyphs = GuiTextMetrics(key.sdf); // SDF advances are scaled: keep them fractional
+    font.kerning = kerning_for(m_font_id);
+
+    s_glyph_cache.emplace(std::move(key), std::move(font));
+    m_font_ready = true;
+    return true;
+}
+
+const GuiKerning* GuiText::kerning_for(FontId font)
+{
+    auto it = s_kerning.find(font);
+    if (it == s_kerning.end()) {
+        // Once per font file (every size shares the table, in font units)
+        it = s_kerning.emplace(font, GuiKerning()).first;
+        it->second.load(GuiFontRegistry::instance().face(font));
+    }
+    return it->second.empty() ? nullptr : &it->second;
+}
 
-    // Load face
-    FT_Library lib = reinterpret_cast<FT_Library>(s_ft_library);
-    FT_Face face = nullptr;
-    if (FT_New_Face(lib, m_font_path.c_str(), 0, &face) != 0) {
-        std::fprintf(stderr, "[GuiText] Failed to load font face: %s\n", m_font_path.c_str());
+bool GuiText::load_baked_fonts(const std::string& path)
+{
+    using namespace GuiFontBake;
+    GuiFontRegistry::MappedFile file;
+    if (!GuiFontRegistry::map_file(path, file)) {
+        std::fprintf(stderr, "[GuiText] No baked fonts at %s (glyphs are rasterized at runtime).\n", path.c_str());
+        return false;
+    }
+    // Every record is bounds-checked against the mapping before use
+    auto in_file = [&](std::uint64_t offset, std::uint64_t bytes) { return offset + bytes <= file.size; };
+    FileHeader header;
+    bool ok = in_file(0, sizeof(header));
+    if (ok) {
+        std::memcpy(&header, file.data, sizeof(header));
+        ok = std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 && header.version == kVersion &&
+             in_file(sizeof(header), static_cast<std::uint64_t>(header.font_count) * sizeof(FontHeader));
+    }
+    if (!ok) {
+        std::fprintf(stderr, "[GuiText] Not a baked font file (or wrong version): %s\n", path.c_str());
+        GuiFontRegistry::unmap_file(file);
         return false;
     }
-    FT_Set_Pixel_Sizes(face, 0, static_cast<FT_UInt>(px));
 
-    // Setup GL unpack alignment for single channel glyph bitmaps
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    int installed = 0;
+    for (std::uint32_t i = 0; i < header.font_count; ++i) {
+        FontHeader fh;
+        std::memcpy(&fh, file.data + sizeof(header) + i * sizeof(FontHeader), sizeof(fh));
+        const bool sdf = (fh.flags & kFlagSdf) != 0;
+        const std::uint64_t pixel_bytes = static_cast<std::uint64_t>(fh.atlas_width > 0 ? fh.atlas_width : 0) *
+                                          static_cast<std::uint64_t>(fh.atlas_height > 0 ? fh.atlas_height : 0);
+        if (!in_file(fh.path_offset, fh.path_length) ||
+            !in_file(fh.glyphs_offset, static_cast<std::uint64_t>(fh.glyph_count) * sizeof(GlyphRecord)) ||
+            !in_file(fh.shelves_offset, static_cast<std::uint64_t>(fh.shelf_count) * sizeof(ShelfRecord)) ||
+            !in_file(fh.pixels_offset, pixel_bytes) || (sdf && fh.pixel_size != kSdfBasePx) ||
+            !in_file(fh.kern_offset, static_cast<std::uint64_t>(fh.kern_count) * sizeof(KernRecord))) {
+            std::fprintf(stderr, "[GuiText] Skipping malformed baked font %u in %s\n", i, path.c_str());
+            continue;
+        }
+        const std::string font_path(reinterpret_cast<const char*>(file.data + fh.path_offset), fh.path_length);
+        FontKey key{GuiFontRegistry::instance().reserve(font_path), fh.pixel_size, sdf};
+        if (key.font == kInvalidFontId || s_glyph_cache.count(key)) continue; // already loaded
+        if ((fh.flags & kFlagKerning) && !s_kerning.count(key.font)) {
+            std::vector<GuiKerning::Pair> pairs(fh.kern_count);
+            for (std::uint32_t k = 0; k < fh.kern_count; ++k) {
+                KernRecord kr;
+                std::memcpy(&kr, file.data + fh.kern_offset + k * sizeof(KernRecord), sizeof(kr));
+                pairs[k] = GuiKerning::Pair{kr.left, kr.right, kr.value};
+            }
+            s_kerning[key.font].set_pairs(pairs, fh.units_per_em);
+        }
 
-    GlyphMap glyphs;
-    glyphs.reserve(96);
+        std::vector<GuiGlyphAtlas::Shelf> shelves(fh.shelf_count);
+        for (std::uint32_t k = 0; k < fh.shelf_count; ++k) {
+            ShelfRecord sr;
+            std::memcpy(&sr, file.data + fh.shelves_offset + k * sizeof(ShelfRecord), sizeof(sr));
+            shelves[k].y = sr.y;
+            shelves[k].height = sr.height;
+            shelves[k].cursor_x = sr.cursor_x;
+        }
+        std::vector<GlyphRecord> records(fh.glyph_count);
+        if (fh.glyph_count > 0) std::memcpy(records.data(), file.data + fh.glyphs_offset, records.size() * sizeof(GlyphRecord));
+        std::vector<std::pair<std::uint64_t, GuiGlyphAtlas::Rect>> rects;
+        rects.reserve(records.size());
+        for (const GlyphRecord& g : records) {
+            GuiGlyphAtlas::Rect r;
+            r.x = g.x; r.y = g.y; r.w = g.w; r.h = g.h;
+            rects.emplace_back(g.codepoint, r);
+        }
 
-    // ASCII range 32..126 (printables)
-    for (unsigned long c = 32; c <= 126; ++c) {
-        if (FT_Load_Char(face, static_cast<FT_ULong>(c), FT_LOAD_RENDER) != 0) {
-            std::fprintf(stderr, "[GuiText] FT_Load_Char failed for '%c' (U+%lu)\n", (char)c, c);
+        FontData font;
+        font.font_id = key.font;
+        font.sdf = sdf;
+        font.raster_px = fh.pixel_size;
+        font.glyphs = GuiTextMetrics(sdf);
+        auto kern = s_kerning.find(key.font);
+        if (kern != s_kerning.end() && !kern->second.empty()) font.kerning = &kern->second;
+        const int max_side = std::max(atlas_side_for_budget(s_glyph_budget), std::max(fh.atlas_width, fh.atlas_height));
+        font.atlas.reset(new GuiGlyphAtlas(256, max_side));
+        font.atlas->set_relayout_hook(&GuiDraw::submit);
+        if (!font.atlas->restore(fh.atlas_width, fh.atlas_height, file.data + fh.pixels_offset, shelves, rects)) {
+            std::fprintf(stderr, "[GuiText] Skipping malformed baked font %u in %s\n", i, path.c_str());
             continue;
         }
-        FT_GlyphSlot g = face->glyph;
-
-        unsigned int tex = 0;
-        glGenTextures(1, &tex);
-        glBindTexture(GL_TEXTURE_2D, tex);
-        // Store grayscale in RED channel
-        glTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            GL_R8,
-            g->bitmap.width,
-            g->bitmap.rows,
-            0,
-            GL_RED,
-            GL_UNSIGNED_BYTE,
-            g->bitmap.buffer
-        );
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        GLint swizzleMask[] = {GL_RED, GL_RED, GL_RED, GL_RED};
-        glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzleMask);
-
-        Glyph ch;
-        ch.texture_id = tex;
-        ch.width = g->bitmap.width;
-        ch.height = g->bitmap.rows;
-        ch.bearing_x = g->bitmap_left;
-        ch.bearing_y = g->bitmap_top;
-        ch.advance = static_cast<unsigned int>(g->advance.x);
-
-        glyphs.emplace(c, ch);
-    }
-
-    FT_Done_Face(face);
-
-    s_glyph_cache.emplace(std::move(key), std::move(glyphs));
-    m_font_ready = true;
+        for (std::size_t k = 0; k < records.size(); ++k) {
+            const GlyphRecord& g = records[k];
+            Glyph ch;
+            ch.width = g.w;
+            ch.height = g.h;
+            ch.bearing_x = g.bearing_x;
+            ch.bearing_y = g.bearing_y;
+            ch.advance = g.advance;
+            ch.pad = g.pad;
+            ch.glyph_index = g.glyph_index;
+            font.atlas->uv_rect(rects[k].second, ch.u0, ch.v0, ch.u1, ch.v1);
+            font.glyphs.insert(g.codepoint, ch);
+        }
+        font.uv_generation = font.atlas->generation();
+        s_glyph_cache.emplace(key, std::move(font));
+        ++installed;
+    }
+    GuiFontRegistry::unmap_file(file); // atlases keep their own copy
+    return installed > 0;
+}
+
+bool GuiText::set_font_fallbacks(const std::string& font_path, const std::vector<std::string>& fallback_paths)
+{
+    GuiFontRegistry& registry = GuiFontRegistry::instance();
+    bool ok = true;
+    std::vector<FontId> chain;
+    for (const std::string& path : fallback_paths) {
+        const FontId id = registry.load(path);
+        if (id == kInvalidFontId) ok = false; // reported by GuiFontRegistry::load
+        else chain.push_back(id);
+    }
+    if (font_path.empty()) {
+        s_default_fallbacks = chain;
+        for (auto& kv : s_fallbacks) {
+            if (!kv.second.own_chain) kv.second.resolved.clear();
+        }
+        return ok;
+    }
+    const FontId primary = registry.reserve(font_path);
+    if (primary == kInvalidFontId) return false;
+    FontFallback& fallback = s_fallbacks[primary];
+    fallback.own_chain = true;
+    fallback.chain = chain;
+    fallback.resolved.clear();
+    return ok;
+}
+
+FontId GuiText::resolve_font(FontId primary, unsigned long codepoint)
+{
+    auto it = s_fallbacks.find(primary);
+    const bool own = it != s_fallbacks.end() && it->second.own_chain;
+    if (!own && s_default_fallbacks.empty()) return primary; // no chain: no probe
+    FontFallback& fallback = (it != s_fallbacks.end()) ? it->second : s_fallbacks[primary];
+    auto found = fallback.resolved.find(codepoint);
+    if (found != fallback.resolved.end()) return found->second;
+
+    // First font of the chain whose cmap has it; .notdef of the primary otherwise
+    GuiFontRegistry& registry = GuiFontRegistry::instance();
+    FontId source = primary;
+    if (registry.char_index(primary, codepoint) == 0) {
+        for (FontId id : own ? fallback.chain : s_default_fallbacks) {
+            if (id != primary && registry.char_index(id, codepoint) != 0) {
+                source = id;
+                break;
+            }
+        }
+    }
+    fallback.resolved.emplace(codepoint, source);
+    return source;
+}
+
+GuiText::Glyph* GuiText::glyph_for(FontData& font, unsigned long codepoint)
+{
+    const unsigned long frame = GuiDraw::frame_index();
+    if (Glyph* cached = font.glyphs.find(codepoint)) {
+        cached->last_used = frame;
+        return cached;
+    }
+
+    // Fallback glyphs go into this font's atlas and table like its own ones;
+    // their glyph index belongs to another face, so they take no kerning
+    const FontId source = resolve_font(font.font_id, codepoint);
+    const bool fallback = source != font.font_id;
+    Glyph ch;
+    ch.last_used = frame;
+    GuiGlyphRasterizer& rasterizer = GuiGlyphRasterizer::instance();
+    if (s_async_glyphs && rasterizer.available() && predict_glyph(font, source, codepoint, ch)) {
+        // Layout uses the predicted metrics; a worker renders the bitmap
+        GuiGlyphRasterizer::Job job;
+        if (GuiFontRegistry::instance().file_data(source, job.file_data, job.file_size)) {
+            if (fallback) ch.glyph_index = 0;
+            job.owner = &font;
+            job.font = source;
+            job.pixel_size = font.raster_px;
+            job.codepoint = codepoint;
+            job.sdf_spread = font.sdf ? kSdfSpread : 0;
+            rasterizer.submit(job);
+            ch.pending = true;
+            return font.glyphs.insert(codepoint, ch);
+        }
+        ch = Glyph();
+        ch.last_used = frame;
+    }
+
+    GuiFontRegistry& registry = GuiFontRegistry::instance();
+    if (!registry.activate(source, font.raster_px)) return nullptr;
+    FT_Face face = reinterpret_cast<FT_Face>(registry.face(source));
+    if (FT_Load_Char(face, static_cast<FT_ULong>(codepoint), FT_LOAD_RENDER) != 0) {
+        std::fprintf(stderr, "[GuiText] FT_Load_Char failed for U+%04lX\n", codepoint);
+        return nullptr;
+    }
+    FT_GlyphSlot g = face->glyph;
+    ch.width = g->bitmap.width;
+    ch.height = g->bitmap.rows;
+    ch.bearing_x = g->bitmap_left;
+    ch.bearing_y = g->bitmap_top;
+    ch.advance = static_cast<unsigned int>(g->advance.x);
+    ch.glyph_index = fallback ? 0 : g->glyph_index;
+
+    const unsigned char* pixels = g->bitmap.buffer;
+    int pitch = g->bitmap.pitch;
+    std::vector<unsigned char> sdf_pixels;
+    if (font.sdf && ch.width > 0 && ch.height > 0) {
+        // Distance field padded by the spread on every side
+        GuiSdf::from_coverage(g->bitmap.buffer, ch.width, ch.height, pitch, kSdfSpread,
+                              sdf_pixels, ch.width, ch.height);
+        pixels = sdf_pixels.data();
+        pitch = ch.width;
+        ch.pad = kSdfSpread;
+        ch.bearing_x -= kSdfSpread;
+        ch.bearing_y += kSdfSpread;
+    }
+    if (!place_glyph(font, codepoint, ch, pixels, pitch)) return nullptr;
+    return font.glyphs.insert(codepoint, ch);
+}
+
+GuiText::Glyph* GuiText::glyph_for(FontData& font, unsigned long codepoint, int& skipped)
+{
+    const unsigned int before = font.skipped;
+    Glyph* g = glyph_for(font, codepoint);
+    if (!g && font.skipped != before) ++skipped;
+    return g;
+}
+
+bool GuiText::predict_glyph(FontData& font, FontId source, unsigned long codepoint, Glyph& out)
+{
+    // Load the outline only (no rendering): the bitmap box is its control box
+    // rounded out to whole pixels, as FreeType's renderer computes it
+    GuiFontRegistry& registry = GuiFontRegistry::instance();
+    if (!registry.activate(source, font.raster_px)) return false;
+    FT_Face face = reinterpret_cast<FT_Face>(registry.face(source));
+    if (FT_Load_Char(face, static_cast<FT_ULong>(codepoint), FT_LOAD_DEFAULT) != 0) return false;
+    FT_GlyphSlot g = face->glyph;
+    if (g->format != FT_GLYPH_FORMAT_OUTLINE) return false; // embedded bitmaps: render now
+
+    FT_BBox box;
+    FT_Outline_Get_CBox(&g->outline, &box);
+    const FT_Pos x0 = box.xMin & ~63, y0 = box.yMin & ~63;
+    const FT_Pos x1 = (box.xMax + 63) & ~63, y1 = (box.yMax + 63) & ~63;
+    out.width = static_cast<int>((x1 - x0) / 64);
+    out.height = static_cast<int>((y1 - y0) / 64);
+    out.bearing_x = static_cast<int>(x0 / 64);
+    out.bearing_y = static_cast<int>(y1 / 64);
+    out.advance = static_cast<unsigned int>(g->advance.x);
+    out.glyph_index = g->glyph_index;
+    if (font.sdf && out.width > 0 && out.height > 0) {
+        out.width += 2 * kSdfSpread;
+        out.height += 2 * kSdfSpread;
+        out.pad = kSdfSpread;
+        out.bearing_x -= kSdfSpread;
+        out.bearing_y += kSdfSpread;
+    }
     return true;
 }
 
-float GuiText::text_width_pixels() const
+bool GuiText::place_glyph(FontData& font, unsigned long codepoint, Glyph& glyph,
+                          const unsigned char* pixels, int pitch)
 {
-    if (m_text.empty()) return 0.0f;
-    if (!ensure_font_loaded()) return 0.0f;
-    const int px = pixel_size_for_level();
-    FontKey key{m_font_path, px};
-    auto it = s_glyph_cache.find(key);
-    if (it == s_glyph_cache.end()) return 0.0f;
-    const GlyphMap& glyphs = it->second;
-    float width = 0.0f;
-    for (unsigned char ch : m_text) {
-        auto ig = glyphs.find(ch);
-        if (ig == glyphs.end()) continue;
-        const Glyph& g = ig->second;
-        width += static_cast<float>(g.advance >> 6);
+    GuiGlyphAtlas& atlas = *font.atlas;
+    if (!atlas.add(codepoint, pixels, glyph.width, glyph.height, pitch)) {
+        // At budget: drop glyphs not drawn this frame, then retry once
+        if (!evict_glyphs(font) || !atlas.add(codepoint, pixels, glyph.width, glyph.height, pitch)) {
+            if (!font.warned_full) {
+                std::fprintf(stderr, "[GuiText] Glyph cache budget exceeded (%dx%d atlas), skipping glyphs.\n",
+                             atlas.width(), atlas.height());
+                font.warned_full = true;
+            }
+            font.skipped += 1;
+            return false;
+        }
     }
-    return width;
+    GuiGlyphAtlas::Rect r;
+    if (atlas.find(codepoint, r)) atlas.uv_rect(r, glyph.u0, glyph.v0, glyph.u1, glyph.v1);
+    return true;
 }
 
-std::pair<float,float> GuiText::preferred_size() const
+void GuiText::upload_ready_glyphs()
 {
-    // width = sum of advances, height = pixel size
-    float w = text_width_pixels();
-    float h = static_cast<float>(pixel_size_for_level());
-    return {w, h};
+    const unsigned long frame = GuiDraw::frame_index();
+    if (s_upload_frame == frame) return;
+    s_upload_frame = frame;
+
+    // Runs that left glyphs out at the budget are laid out again: glyphs not
+    // drawn last frame are evictable now, so the retry can make room
+    for (auto& kv : s_glyph_cache) {
+        FontData& font = kv.second;
+        if (font.skipped == 0) continue;
+        font.skipped = 0;
+        font.glyph_epoch += 1;
+    }
+
+    static std::vector<GuiGlyphRasterizer::Result> results;
+    results.clear();
+    if (GuiGlyphRasterizer::instance().take_results(results, s_upload_budget) == 0) return;
+
+    for (GuiGlyphRasterizer::Result& r : results) {
+        FontData& font = *static_cast<FontData*>(const_cast<void*>(r.job.owner));
+        const unsigned long cp = r.job.codepoint;
+        const Glyph* pending = font.glyphs.find(cp);
+        if (!pending || !pending->pending) continue;
+
+        // Runs laid out with this glyph pending are rebuilt
+        font.glyph_epoch += 1;
+        Glyph ch = *pending;
+        ch.pending = false;
+        if (r.ok) {
+            ch.width = r.width;
+            ch.height = r.height;
+            ch.bearing_x = r.bearing_x;
+            ch.bearing_y = r.bearing_y;
+            ch.advance = r.advance;
+            ch.pad = r.pad;
+        } else {
+            ch.width = 0; // keep the advance, draw nothing
+            ch.height = 0;
+        }
+        // The entry stays pending (not evictable) while the atlas makes room
+        if (ch.width > 0 && ch.height > 0 && !place_glyph(font, cp, ch, r.pixels.data(), ch.width)) {
+            font.glyphs.erase(cp); // retried on next use
+            continue;
+        }
+        font.glyphs.insert(cp, ch);
+    }
 }
 
-bool GuiText::vertical_extents(float& ascent, float& descent) const
+float GuiText::kerning_px(const FontData& font, unsigned int left, unsigned int right)
 {
-    ascent = 0.0f; descent = 0.0f;
+    // Kerning values are font units: scaled to the raster size, rounded to
+    // whole pixels like the advances of coverage glyphs
+    if (!font.kerning) return 0.0f;
+    const int units = font.kerning->adjust(left, right);
+    if (units == 0) return 0.0f;
+    const float kern = static_cast<float>(units) * static_cast<float>(font.raster_px) /
+                       static_cast<float>(font.kerning->units_per_em());
+    return font.sdf ? kern : std::round(kern);
+}
+
+const GuiText::ShapedRun& GuiText::shape(FontData& font, const std::string& str)
+{
+    auto it = font.shaped.find(str);
+    if (it != font.shaped.end() &&
+        ((it->second.pending == 0 && it->second.skipped == 0) || it->second.glyph_epoch == font.glyph_epoch)) {
+        return it->second;
+    }
+    if (it == font.shaped.end()) {
+        if (font.shaped.size() >= kMaxShapedRuns) font.shaped.clear(); // strings of the moment get reshaped
+        it = font.shaped.emplace(str, ShapedRun()).first;
+    }
+    ShapedRun& run = it->second;
+    run.codepoints.clear();
+    run.pen_x.clear();
+    run.pending = 0;
+    run.skipped = 0;
+
+    float pen_x = 0.0f;
+    unsigned int prev_index = 0;
+    for (std::size_t i = 0; i < str.size();) {
+        unsigned long cp = 0;
+        if (!next_codepoint(str, i, cp)) continue;
+        const Glyph* g = glyph_for(font, cp, run.skipped);
+        if (!g) continue;
+        if (prev_index != 0) pen_x += kerning_px(font, prev_index, g->glyph_index);
+        run.codepoints.push_back(cp);
+        run.pen_x.push_back(pen_x);
+        pen_x += font.sdf ? static_cast<float>(g->advance) / 64.0f : static_cast<float>(g->advance >> 6);
+        prev_index = g->glyph_index;
+        if (g->pending) ++run.pending;
+    }
+    // Vertical extents do not depend on kerning
+    const GuiTextExtents ext = font.glyphs.measure(str);
+    run.width = pen_x;
+    run.ascent = ext.ascent;
+    run.descent = ext.descent;
+    run.glyph_epoch = font.glyph_epoch;
+    return run;
+}
+
+float GuiText::glyph_scale(const FontData& font) const
+{
+    // SDF glyphs are rasterized once and scaled to the requested size
+    return font.sdf ? static_cast<float>(pixel_size_for_level()) / static_cast<float>(font.raster_px) : 1.0f;
+}
+
+bool GuiText::evict_glyphs(FontData& font)
+{
+    // Least recently drawn first; glyphs used this frame are never evicted
+    const unsigned long frame = GuiDraw::frame_index();
+    std::vector<std::pair<unsigned long, unsigned long>> candidates; // (last_used, codepoint)
+    font.glyphs.for_each([&](unsigned long cp, const Glyph& g) {
+        if (g.last_used < frame && !g.pending && g.width > 0 && g.height > 0) candidates.emplace_back(g.last_used, cp);
+    });
+    if (candidates.empty()) return false;
+    std::sort(candidates.begin(), candidates.end());
+
+    // Free about a quarter of the atlas so the next misses do not evict again
+    GuiGlyphAtlas& atlas = *font.atlas;
+    const std::size_t target = static_cast<std::size_t>(atlas.width()) * static_cast<std::size_t>(atlas.height()) / 4u;
+    std::size_t freed = 0;
+    for (const auto& c : candidates) {
+        if (freed >= target) break;
+        const Glyph& g = *font.glyphs.find(c.second);
+        freed += static_cast<std::size_t>(g.width) * static_cast<std::size_t>(g.height);
+        atlas.remove(c.second);
+        font.glyphs.erase(c.second);
+    }
+    return atlas.compact();
+}
+
+void GuiText::refresh_glyph_uvs(FontData& font)
+{
+    // Repacking moves glyphs inside the atlas: re-read every rect
+    GuiGlyphAtlas& atlas = *font.atlas;
+    font.glyphs.for_each([&](unsigned long cp, Glyph& g) {
+        GuiGlyphAtlas::Rect r;
+        if (atlas.find(cp, r)) atlas.uv_rect(r, g.u0, g.v0, g.u1, g.v1);
+    });
+    font.uv_generation = atlas.generation();
+}
+
+float GuiText::atlas_fill_ratio() const
+{
+    const FontData* font = font_data();
+    return font ? font->atlas->fill_ratio() : 0.0f;
+}
+
+bool GuiText::run_current() const
+{
+    if (!m_run.valid || m_run.atlas_generation != m_run.font->atlas->generation()) return false;
+    return m_run.pending == 0 || m_run.glyph_epoch == m_run.font->glyph_epoch;
+}
+
+bool GuiText::layout_run()
+{
+    // Fast path: no font lookup while the run is up to date
+    if (m_run.valid && m_run.pending > 0) upload_ready_glyphs();
+    if (run_current()) return true;
+    m_run.placed = false;
     if (m_text.empty()) return false;
     if (!ensure_font_loaded()) return false;
+    upload_ready_glyphs();
 
     const int px = pixel_size_for_level();
-    FontKey key{m_font_path, px};
-    auto it = s_glyph_cache.find(key);
+    auto it = s_glyph_cache.find(font_key());
     if (it == s_glyph_cache.end()) return false;
-    const GlyphMap& glyphs = it->second;
-
-    float a = 0.0f, d = 0.0f;
-    for (unsigned char ch : m_text) {
-        auto ig = glyphs.find(ch);
-        if (ig == glyphs.end()) continue;
-        const Glyph& g = ig->second;
-        a = std::max(a, static_cast<float>(g.bearing_y));
-        d = std::max(d, static_cast<float>(g.height - g.bearing_y));
+    FontData& font = it->second;
+    if (font.uv_generation != font.atlas->generation()) refresh_glyph_uvs(font);
+    if (m_run.valid && m_run.font == &font && m_run.atlas_generation == font.uv_generation &&
+        (m_run.pending == 0 || m_run.glyph_epoch == font.glyph_epoch)) return true;
+    if (m_number.active) return ensure_number_run(font);
+    if (paragraph_mode()) return ensure_paragraph_run(font);
+
+    RunCache& run = m_run;
+    run.quads.clear();
+    run.glyphs.clear();
+    run.quads.reserve(m_text.size());
+    run.glyphs.reserve(m_text.size());
+
+    // Kerned pen positions come from the memo (shaped once per string). Every
+    // glyph is resolved before quads are built: loading may grow, evict or
+    // repack the atlas (glyphs of this run are stamped with the current
+    // frame, so they stay)
+    const ShapedRun& shaped = shape(font, m_text);
+    std::vector<float> pen_x;
+    pen_x.reserve(shaped.codepoints.size());
+    int skipped = shaped.skipped;
+    for (std::size_t k = 0; k < shaped.codepoints.size(); ++k) {
+        if (Glyph* g = glyph_for(font, shaped.codepoints[k], skipped)) {
+            run.glyphs.push_back(g);
+            pen_x.push_back(shaped.pen_x[k]);
+        }
     }
+    if (font.uv_generation != font.atlas->generation()) refresh_glyph_uvs(font);
+
+    // Extents first (ink only, SDF padding excluded): the baseline sits
+    // `descent` above the bottom of the box
+    const float scale = glyph_scale(font);
+    float a = shaped.ascent * scale, d = shaped.descent * scale;
+    const float width = shaped.width * scale;
     if (a == 0.0f && d == 0.0f) {
         // Fallback heuristic: typical ascent/descent split
         a = px * 0.8f;
         d = px * 0.2f;
     }
-    ascent = a; descent = d;
+    run.width = width;
+    run.ascent = a;
+    run.descent = d;
+    run.height = static_cast<float>(px);
+
+    const float baseline_y = d;
+    run.pending = skipped; // laid out again when the retry has room
+    for (std::size_t k = 0; k < run.glyphs.size(); ++k) {
+        const Glyph& g = *run.glyphs[k];
+        if (g.pending) {
+            ++run.pending; // blank until uploaded; the advance is already final
+        } else if (g.width > 0 && g.height > 0) {
+            GuiDraw::GlyphQuad q;
+            q.x0 = pen_x[k] * scale + static_cast<float>(g.bearing_x) * scale;
+            q.y0 = baseline_y - static_cast<float>(g.height - g.bearing_y) * scale;
+            q.x1 = q.x0 + static_cast<float>(g.width) * scale;
+            q.y1 = q.y0 + static_cast<float>(g.height) * scale;
+            q.u0 = g.u0; q.v0 = g.v0; q.u1 = g.u1; q.v1 = g.v1;
+            run.quads.push_back(q);
+        }
+    }
+
+    run.font = &font;
+    run.atlas_generation = font.uv_generation;
+    run.glyph_epoch = font.glyph_epoch;
+    run.valid = true;
     return true;
 }
 
-void GuiText::draw()
+bool GuiText::ensure_paragraph_run(FontData& font)
 {
-    if (!m_visible) return;
-    if (m_text.empty()) return;
-    if (!ensure_font_loaded()) return;
-    if (!init_renderer()) return;
+    ParagraphCache& para = m_para;
+    RunCache& run = m_run;
+    const bool quads_dirty = para.quads_dirty;
+    if (!para.valid || para.font != &font) {
+        para.lines.clear();
+        para.codepoints.clear();
+        para.pen_x.clear();
+        run.glyphs.clear();
+        run.quads.clear();
+        para.laid_size = 0; // nothing kept
+        para.clean_prefix = 0;
+        para.clean_suffix = 0;
+        para.font = &font;
+        para.atlas_generation = font.atlas->generation();
+        para.glyph_epoch = font.glyph_epoch;
+        para.valid = true;
+    }
+    if (para.glyph_epoch != font.glyph_epoch) {
+        // Lines that left glyphs out at the budget are reflowed (the glyphs
+        // are retried and their advances may move the breaks)
+        std::size_t first = para.lines.size(), last = 0;
+        for (std::size_t l = 0; l < para.lines.size(); ++l) {
+            if (para.lines[l].skipped == 0) continue;
+            first = std::min(first, l);
+            last = l;
+        }
+        if (first < para.lines.size()) {
+            para.clean_prefix = std::min(para.clean_prefix, para.lines[first].begin);
+            para.clean_suffix = std::min(para.clean_suffix, para.laid_size - para.lines[last].next);
+        }
+    }
+    // Reflowed lines get their quads there; the others keep theirs
+    if (para.laid_size != m_text.size() || para.clean_prefix < para.laid_size) reflow_paragraph(font);
+    std::size_t quads_from = quads_dirty ? 0 : para.lines.size();
+
+    // Lines kept from earlier layouts hold glyph pointers: re-resolved when
+    // the atlas was repacked (eviction may have erased them) or when their
+    // pending bitmaps arrived. Advances are final, so breaks do not move.
+    std::size_t resolve_from = para.lines.size();
+    if (para.atlas_generation != font.atlas->generation()) {
+        resolve_from = 0;
+    } else if (para.glyph_epoch != font.glyph_epoch) {
+        for (std::size_t l = 0; l < para.lines.size(); ++l) {
+            if (para.lines[l].pending > 0) { resolve_from = l; break; }
+        }
+    }
+    if (resolve_from < para.lines.size()) {
+        for (std::size_t k = para.lines[resolve_from].glyph_begin; k < para.codepoints.size(); ++k) {
+            run.glyphs[k] = glyph_for(font, para.codepoints[k]);
+        }
+        quads_from = std::min(quads_from, resolve_from);
+    }
+    if (font.uv_generation != font.atlas->generation()) {
+        refresh_glyph_uvs(font);
+        quads_from = 0;
+    }
+    if (para.atlas_generation != font.uv_generation) quads_from = 0; // UVs moved
+    build_paragraph_quads(font, quads_from);
+
+    para.quads_dirty = false;
+    para.atlas_generation = font.uv_generation;
+    para.glyph_epoch = font.glyph_epoch;
+    run.font = &font;
+    run.atlas_generation = font.uv_generation;
+    run.glyph_epoch = font.glyph_epoch;
+    run.valid = true;
+    return true;
+}
 
-    // Ensure we have framebuffer size (if user didn't notify via on_framebuffer_resized)
-    if (s_fb_width <= 0 || s_fb_height <= 0) {
-        GLint vp[4] = {0,0,0,0};
-        glGetIntegerv(GL_VIEWPORT, vp);
-        s_fb_width = vp[2];
-        s_fb_height = vp[3];
+void GuiText::reflow_paragraph(FontData& font)
+{
+    ParagraphCache& para = m_para;
+    RunCache& run = m_run;
+    const std::size_t size = m_text.size();
+    const std::size_t prefix = std::min(para.clean_prefix, std::min(para.laid_size, size));
+    const std::size_t suffix = std::min(para.clean_suffix, std::min(para.laid_size, size) - prefix);
+    const std::size_t old_edit_end = para.laid_size - suffix;    // first unchanged byte (old text)
+    const std::size_t new_edit_end = size - suffix;              // (new text)
+
+    // An edit on line k can pull the first word of k back onto k - 1
+    std::size_t first = 0;
+    while (first < para.lines.size() && para.lines[first].next <= prefix &&
+           para.lines[first].next < para.laid_size) ++first;
+    if (first > 0) --first;
+    std::size_t pos = first < para.lines.size() ? para.lines[first].begin : 0;
+
+    // New lines are laid out into the scratch arrays. Old lines after the
+    // edit stay in place: once a new break lands on one of their starts
+    // (shifted by the size change), they and everything after are unchanged.
+    para.new_lines.clear();
+    para.new_codepoints.clear();
+    para.new_pen_x.clear();
+    para.new_glyphs.clear();
+    para.reflowed_lines = 0;
+    std::size_t kept = para.lines.size(); // first old line kept (none by default)
+    std::size_t t = first;
+    bool ends_with_break = false;
+    while (pos < size) {
+        ParaLine line;
+        lay_line(font, pos, line);
+        ends_with_break = line.next > line.end && m_text[line.end] == '\n' && line.next == size;
+        pos = line.next;
+        para.new_lines.push_back(line);
+        ++para.reflowed_lines;
+
+        if (suffix == 0 || pos < new_edit_end) continue;
+        const std::size_t old_pos = pos + para.laid_size - size; // same byte before the edit
+        while (t < para.lines.size() && para.lines[t].begin < old_pos) ++t;
+        if (t < para.lines.size() && para.lines[t].begin == old_pos && old_pos >= old_edit_end) {
+            kept = t;
+            ends_with_break = false;
+            break;
+        }
+    }
+    if (ends_with_break) {
+        // A final '\n' opens an empty last line
+        ParaLine line;
+        line.begin = line.end = line.next = size;
+        line.glyph_begin = line.glyph_end = para.new_codepoints.size();
+        para.new_lines.push_back(line);
     }
 
-    float proj[16];
-    make_ortho(0.0f, static_cast<float>(s_fb_width), 0.0f, static_cast<float>(s_fb_height), -1.0f, 1.0f, proj);
+    // Old ranges replaced: lines [first, kept), their glyphs and quads
+    const bool converged = kept < para.lines.size();
+    const std::size_t glyph_cut = first < para.lines.size() ? para.lines[first].glyph_begin : para.codepoints.size();
+    const std::size_t glyph_end = converged ? para.lines[kept].glyph_begin : para.codepoints.size();
+    const std::size_t quad_cut = first > 0 ? para.lines[first - 1].quad_end : 0;
+    const std::size_t quad_end = converged ? (kept > first ? para.lines[kept - 1].quad_end : quad_cut) : run.quads.size();
+    splice_range(para.codepoints, glyph_cut, glyph_end - glyph_cut, para.new_codepoints);
+    splice_range(para.pen_x, glyph_cut, glyph_end - glyph_cut, para.new_pen_x);
+    splice_range(run.glyphs, glyph_cut, glyph_end - glyph_cut, para.new_glyphs);
+
+    // Kept lines move by the size change, the glyph count change and (after
+    // the quads are in) the quad count change
+    const std::size_t old_lines = para.lines.size();
+    const std::size_t new_glyph_end = glyph_cut + para.new_codepoints.size();
+    for (std::size_t l = kept; l < old_lines; ++l) {
+        ParaLine& line = para.lines[l];
+        line.begin = line.begin + size - para.laid_size;
+        line.end = line.end + size - para.laid_size;
+        line.next = line.next + size - para.laid_size;
+        line.glyph_begin = line.glyph_begin - glyph_end + new_glyph_end;
+        line.glyph_end = line.glyph_end - glyph_end + new_glyph_end;
+    }
+    for (ParaLine& line : para.new_lines) {
+        line.glyph_begin += glyph_cut;
+        line.glyph_end += glyph_cut;
+    }
+    splice_range(para.lines, first, kept - first, para.new_lines);
+
+    // Quads of the reflowed lines only
+    const std::size_t reflowed_end = first + para.new_lines.size();
+    para.new_quads.clear();
+    for (std::size_t l = first; l < reflowed_end; ++l) {
+        lay_line_quads(font, l, para.new_quads);
+        para.lines[l].quad_end = quad_cut + para.new_quads.size();
+    }
+    splice_range(run.quads, quad_cut, quad_end - quad_cut, para.new_quads);
+    const std::size_t new_quad_end = quad_cut + para.new_quads.size();
+    for (std::size_t l = reflowed_end; l < para.lines.size(); ++l) {
+        para.lines[l].quad_end = para.lines[l].quad_end - quad_end + new_quad_end;
+    }
+    if (converged && para.new_lines.size() != kept - first) {
+        // Kept lines changed index: top-anchored quads move by whole lines
+        const float line_height = static_cast<float>(pixel_size_for_level()) * m_line_spacing;
+        const float dy = -(static_cast<float>(para.new_lines.size()) - static_cast<float>(kept - first)) * line_height;
+        for (std::size_t q = new_quad_end; q < run.quads.size(); ++q) {
+            run.quads[q].y0 += dy;
+            run.quads[q].y1 += dy;
+        }
+    }
+    para.laid_size = size;
+    para.clean_prefix = size;
+    para.clean_suffix = size;
+}
 
-    const int px = pixel_size_for_level();
-    FontKey key{m_font_path, px};
-    auto it = s_glyph_cache.find(key);
-    if (it == s_glyph_cache.end()) return; // should not happen
-    const GlyphMap& glyphs = it->second;
+void GuiText::lay_line(FontData& font, std::size_t pos, ParaLine& line)
+{
+    ParagraphCache& para = m_para;
+    const std::size_t size = m_text.size();
+    const float scale = glyph_scale(font);
+    const float wrap = m_wrap_width;
+    line.begin = pos;
+    line.glyph_begin = para.new_codepoints.size();
+
+    // Greedy wrap: break at the last space that fits, inside a word if none
+    bool have_break = false;
+    std::size_t break_end = 0, break_glyphs = 0;
+    float break_width = 0.0f;
+    float pen_x = 0.0f;
+    unsigned int prev_index = 0;
+    std::size_t i = pos;
+    while (i < size) {
+        const std::size_t cp_begin = i;
+        unsigned long cp = 0;
+        if (!next_codepoint(m_text, i, cp)) continue;
+        if (cp == '\n') {
+            line.end = cp_begin;
+            line.next = i;
+            line.width = pen_x;
+            line.glyph_end = para.new_codepoints.size();
+            return;
+        }
+        Glyph* g = glyph_for(font, cp, line.skipped);
+        if (!g) continue;
+        const float kern = prev_index != 0 ? kerning_px(font, prev_index, g->glyph_index) * scale : 0.0f;
+        const float advance = font.sdf ? static_cast<float>(g->advance) / 64.0f * scale : static_cast<float>(g->advance >> 6);
+        if (cp == ' ') {
+            if (para.new_codepoints.size() > line.glyph_begin) {
+                have_break = true;
+                break_end = cp_begin;
+                break_glyphs = para.new_codepoints.size();
+                break_width = pen_x;
+            }
+        } else if (pen_x + kern + advance > wrap && para.new_codepoints.size() > line.glyph_begin) {
+            if (have_break) {
+                // The partial word moves to the next line (laid out again there)
+                para.new_codepoints.resize(break_glyphs);
+                para.new_pen_x.resize(break_glyphs);
+                para.new_glyphs.resize(break_glyphs);
+                std::size_t next = break_end;
+                while (next < size && m_text[next] == ' ') ++next;
+                line.end = break_end;
+                line.next = next;
+                line.width = break_width;
+            } else {
+                line.end = cp_begin;
+                line.next = cp_begin;
+                line.width = pen_x;
+            }
+            line.glyph_end = para.new_codepoints.size();
+            return;
+        }
+        pen_x += kern;
+        para.new_codepoints.push_back(cp);
+        para.new_pen_x.push_back(pen_x);
+        para.new_glyphs.push_back(g);
+        pen_x += advance;
+        prev_index = g->glyph_index;
+    }
+    line.end = size;
+    line.next = size;
+    line.width = pen_x;
+    line.glyph_end = para.new_codepoints.size();
+}
+
+void GuiText::lay_line_quads(const FontData& font, std::size_t index, std::vector<GuiDraw::GlyphQuad>& out)
+{
+    const ParagraphCache& para = m_para;
+    ParaLine& line = m_para.lines[index];
+    const float scale = glyph_scale(font);
+    const float px = static_cast<float>(pixel_size_for_level());
+    const float ascent = px * 0.8f; // first baseline below the top (same split as the single-line fallback)
+    float x0 = 0.0f;
+    if (m_align == TextAlign::Center) x0 = 0.5f * (m_wrap_width - line.width);
+    else if (m_align == TextAlign::Right) x0 = m_wrap_width - line.width;
+    const float baseline_y = -(static_cast<float>(index) * px * m_line_spacing + ascent);
+    line.pending = 0;
+    for (std::size_t k = line.glyph_begin; k < line.glyph_end; ++k) {
+        const Glyph* gp = m_run.glyphs[k];
+        if (!gp) {
+            ++line.pending; // evicted and not reloaded: retried like a pending glyph
+            continue;
+        }
+        const Glyph& g = *gp;
+        if (g.pending) {
+            ++line.pending;
+        } else if (g.width > 0 && g.height > 0) {
+            GuiDraw::GlyphQuad q;
+            q.x0 = x0 + para.pen_x[k] + static_cast<float>(g.bearing_x) * scale;
+            q.y0 = baseline_y - static_cast<float>(g.height - g.bearing_y) * scale;
+            q.x1 = q.x0 + static_cast<float>(g.width) * scale;
+            q.y1 = q.y0 + static_cast<float>(g.height) * scale;
+            q.u0 = g.u0; q.v0 = g.v0; q.u1 = g.u1; q.v1 = g.v1;
+            out.push_back(q);
+        }
+    }
+}
+
+void GuiText::build_paragraph_quads(const FontData& font, std::size_t from_line)
+{
+    ParagraphCache& para = m_para;
+    RunCache& run = m_run;
+    const float px = static_cast<float>(pixel_size_for_level());
+    const float line_height = px * m_line_spacing;
+    const float ascent = px * 0.8f;
+
+    from_line = std::min(from_line, para.lines.size());
+    run.quads.resize(from_line > 0 ? para.lines[from_line - 1].quad_end : 0);
+    for (std::size_t l = from_line; l < para.lines.size(); ++l) {
+        lay_line_quads(font, l, run.quads);
+        para.lines[l].quad_end = run.quads.size();
+    }
+
+    run.pending = 0;
+    for (const ParaLine& line : para.lines) run.pending += line.pending + line.skipped;
+    const std::size_t count = para.lines.size();
+    run.width = m_wrap_width;
+    run.height = count > 0 ? static_cast<float>(count - 1) * line_height + px : 0.0f;
+    run.ascent = ascent;
+    run.descent = run.height - ascent;
+}
+
+bool GuiText::ensure_number_run(FontData& font)
+{
+    NumberCache& num = m_number;
+    RunCache& run = m_run;
+    const float scale = glyph_scale(font);
+    const bool relayout = !num.laid || run.font != &font || run.atlas_generation != font.uv_generation ||
+                          (run.pending > 0 && run.glyph_epoch != font.glyph_epoch);
+    if (relayout) {
+        // Load everything first, then take glyph pointers: loading may grow,
+        // evict or repack the atlas (glyphs of this run are stamped with the
+        // current frame, so they stay)
+        for (int c = 0; c < kNumberGlyphs; ++c) glyph_for(font, static_cast<unsigned char>(kNumberChars[c]));
+        std::vector<unsigned long> codepoints[2];
+        std::vector<float> pen[2];
+        float affix_width[2];
+        int affix_skipped = 0;
+        const std::string* affixes[2] = {&num.prefix, &num.suffix};
+        for (int a = 0; a < 2; ++a) {
+            const ShapedRun& shaped = shape(font, *affixes[a]);
+            codepoints[a] = shaped.codepoints;
+            pen[a] = shaped.pen_x;
+            affix_width[a] = shaped.width;
+            affix_skipped += shaped.skipped;
+        }
+        run.glyphs.clear();
+        run.pending = affix_skipped; // glyphs skipped at the budget count as pending
+        num.digit_advance = 0.0f;
+        for (int c = 0; c < kNumberGlyphs; ++c) {
+            num.glyphs[c] = glyph_for(font, static_cast<unsigned char>(kNumberChars[c]), run.pending);
+            if (!num.glyphs[c]) continue;
+            run.glyphs.push_back(num.glyphs[c]);
+            if (num.glyphs[c]->pending) ++run.pending;
+            if (c < 10) num.digit_advance = std::max(num.digit_advance, advance_px(*num.glyphs[c], font.sdf));
+        }
+        if (font.uv_generation != font.atlas->generation()) refresh_glyph_uvs(font);
+
+        // Extents cover every digit: the box does not move as the value changes
+        const int px = pixel_size_for_level();
+        const GuiTextExtents ext = font.glyphs.measure(num.prefix + "0123456789" + num.suffix);
+        float asc = ext.ascent * scale, desc = ext.descent * scale;
+        if (asc == 0.0f && desc == 0.0f) {
+            asc = px * 0.8f;
+            desc = px * 0.2f;
+        }
+        run.ascent = asc;
+        run.descent = desc;
+        run.height = static_cast<float>(px);
+
+        run.quads.clear();
+        num.suffix_quads.clear();
+        for (int a = 0; a < 2; ++a) {
+            std::vector<GuiDraw::GlyphQuad>& out = (a == 0) ? run.quads : num.suffix_quads;
+            for (std::size_t k = 0; k < codepoints[a].size(); ++k) {
+                Glyph* g = glyph_for(font, codepoints[a][k], run.pending);
+                if (!g) continue;
+                run.glyphs.push_back(g);
+                if (g->pending) ++run.pending;
+                else if (g->width > 0 && g->height > 0) out.push_back(glyph_quad(g, pen[a][k], desc, scale));
+            }
+        }
+        num.prefix_quads = run.quads.size();
+        num.origin_x = affix_width[0];
+        num.suffix_width = affix_width[1];
+        num.pen_x[0] = num.origin_x;
+        num.laid_len = 0;
+        num.laid = true;
+    }
+
+    // Digits replaced by digits keep their slot and pen position; from the
+    // first other change on, slots and the suffix are laid out again
+    int from = std::min(num.laid_len, num.len);
+    for (int k = 0; k < from; ++k) {
+        const char c = num.text[k], old = num.laid_text[k];
+        if (c == old) continue;
+        if (c < '0' || c > '9' || old < '0' || old > '9') { from = k; break; }
+        const Glyph* g = num.glyphs[c - '0'];
+        const float adv = g ? advance_px(*g, font.sdf) : 0.0f;
+        run.quads[num.prefix_quads + static_cast<std::size_t>(k)] =
+            glyph_quad(g, num.pen_x[k] + (num.digit_advance - adv) * 0.5f, run.descent, scale);
+    }
+    if (from < num.len || num.laid_len != num.len) lay_number_chars(font, from);
+    std::memcpy(num.laid_text, num.text, static_cast<std::size_t>(num.len));
+    num.laid_len = num.len;
+
+    run.font = &font;
+    run.atlas_generation = font.uv_generation;
+    run.glyph_epoch = font.glyph_epoch;
+    run.valid = true;
+    return true;
+}
+
+void GuiText::lay_number_chars(const FontData& font, int from)
+{
+    NumberCache& num = m_number;
+    RunCache& run = m_run;
+    const float scale = glyph_scale(font);
+    run.quads.resize(num.prefix_quads + static_cast<std::size_t>(num.len) + num.suffix_quads.size());
+
+    // Digits are centered in cells of the widest digit's advance
+    float pen = num.pen_x[from];
+    for (int k = from; k < num.len; ++k) {
+        const char c = num.text[k];
+        const Glyph* g = num.glyphs[number_glyph_index(c)];
+        const float adv = g ? advance_px(*g, font.sdf) : 0.0f;
+        const float cell = (c >= '0' && c <= '9') ? num.digit_advance : adv;
+        num.pen_x[k] = pen;
+        run.quads[num.prefix_quads + static_cast<std::size_t>(k)] =
+            glyph_quad(g, pen + (cell - adv) * 0.5f, run.descent, scale);
+        pen += cell;
+    }
+    num.pen_x[num.len] = pen;
+
+    const float shift = pen * scale;
+    GuiDraw::GlyphQuad* out = run.quads.data() + num.prefix_quads + num.len;
+    for (const GuiDraw::GlyphQuad& q : num.suffix_quads) {
+        *out = q;
+        out->x0 += shift;
+        out->x1 += shift;
+        ++out;
+    }
+    run.width = (pen + num.suffix_width) * scale;
+}
+
+int GuiText::line_count() const
+{
+    if (!m_run.valid) return 0;
+    return paragraph_mode() ? static_cast<int>(m_para.lines.size()) : 1;
+}
+
+float GuiText::text_width_pixels() const
+{
+    return m_run.valid ? m_run.width : 0.0f;
+}
+
+std::pair<float,float> GuiText::preferred_size() const
+{
+    // width = sum of kerned advances, height = pixel size (paragraph: wrap width x lines)
+    float w = text_width_pixels();
+    float h = (paragraph_mode() && m_run.valid) ? m_run.height : static_cast<float>(pixel_size_for_level());
+    return {w, h};
+}
+
+bool GuiText::measure_text(const std::string& str, float& width, float& ascent, float& descent) const
+{
+    width = 0.0f; ascent = 0.0f; descent = 0.0f;
+    FontData* loaded = font_data();
+    if (!loaded) return false;
+    FontData& font = *loaded;
+
+    // Kerned width from the shaping memo: a string already seen costs one lookup
+    const float scale = glyph_scale(font);
+    const ShapedRun& shaped = shape(font, str);
+    width = shaped.width * scale;
+    ascent = shaped.ascent * scale;
+    descent = shaped.descent * scale;
+    if (ascent == 0.0f && descent == 0.0f) {
+        // Same fallback as the cached run
+        const float px = static_cast<float>(pixel_size_for_level());
+        ascent = px * 0.8f;
+        descent = px * 0.2f;
+    }
+    return true;
+}
+
+bool GuiText::vertical_extents(float& ascent, float& descent) const
+{
+    ascent = 0.0f; descent = 0.0f;
+    if (!m_run.valid) return false;
+    ascent = m_run.ascent;
+    descent = m_run.descent;
+    return true;
+}
 
+void GuiText::place_run()
+{
     // Determine bounding box from alignment or manual position
     float x = pixel_x_from_pos();
     float y = pixel_y_from_pos();
     // Prefer bounding box width/height for anchor computation
-    float box_w = text_width_pixels();
-    float box_h = static_cast<float>(pixel_size_for_level());
+    float box_w = m_run.width;
+    float box_h = m_run.height;
     if (position_mode() == PositionMode::Aligned && !m_has_parent) {
         // Use framebuffer as parent if none was provided
         // compute_aligned_xy expects bottom-left of the bounding box
         compute_aligned_xy(box_w, box_h, x, y);
     }
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    GLboolean depthWasEnabled = glIsEnabled(GL_DEPTH_TEST);
-    if (depthWasEnabled) glDisable(GL_DEPTH_TEST); // HUD overlay
-
-    glActiveTexture(GL_TEXTURE0);
-    glUseProgram(s_shader);
-    glUniformMatrix4fv(s_uProjLoc, 1, GL_FALSE, proj);
-    float final_col[4];
-    apply_animation_to_color(m_color, final_col);
-    glUniform4fv(s_uTextColorLoc, 1, final_col);
-
-    glBindVertexArray(s_vao);
-    glBindBuffer(GL_ARRAY_BUFFER, s_vbo);
-
-    // Before we generate glyph quads, capture original rect to compute animated transform
+    // Animation (offset + scale around the box center) becomes one transform
+    // applied to the cached run on the GPU: p' = p * scale + offset
     float old_x = x, old_y = y, old_w = (box_w > 0.0f ? box_w : 1.0f), old_h = (box_h > 0.0f ? box_h : 1.0f);
-    // Apply animation (offset + scale) to overall text bounding box
     apply_animation_to_rect(x, y, box_w, box_h);
     float center_old_x = old_x + 0.5f * old_w;
     float center_old_y = old_y + 0.5f * old_h;
@@ -405,57 +1420,77 @@ void GuiText::draw()
     float sx_anim = (old_w != 0.0f) ? (box_w / old_w) : 1.0f;
     float sy_anim = (old_h != 0.0f) ? (box_h / old_h) : 1.0f;
 
-    float pen_x = old_x; // use original geometry for layout, then transform to animated space per-vertex
-    float baseline_y = old_y; // y is bottom of bounding box
-    float asc = 0.0f, desc = 0.0f;
-    bool have_extents = vertical_extents(asc, desc);
-    if (have_extents) {
-        baseline_y = y + desc; // move from bottom of box to baseline
-    }
-
-    for (unsigned char ch : m_text) {
-        auto ig = glyphs.find(ch);
-        if (ig == glyphs.end()) continue;
-        const Glyph& g = ig->second;
-
-        float xpos = pen_x + static_cast<float>(g.bearing_x);
-        float ypos = baseline_y - static_cast<float>(g.height - g.bearing_y);
-        float w = static_cast<float>(g.width);
-        float h = static_cast<float>(g.height);
-
-        float verts[6][4] = {
-            { xpos,     ypos + h, 0.0f, 0.0f },
-            { xpos,     ypos,     0.0f, 1.0f },
-            { xpos + w, ypos,     1.0f, 1.0f },
-
-            { xpos,     ypos + h, 0.0f, 0.0f },
-            { xpos + w, ypos,     1.0f, 1.0f },
-            { xpos + w, ypos + h, 1.0f, 0.0f },
-        };
-
-        // Apply animated transform (scale around center + translate to new center)
-        for (int vi = 0; vi < 6; ++vi) {
-            float vx = verts[vi][0];
-            float vy = verts[vi][1];
-            // scale around old center
-            float dx = vx - center_old_x;
-            float dy = vy - center_old_y;
-            vx = center_new_x + dx * sx_anim;
-            vy = center_new_y + dy * sy_anim;
-            verts[vi][0] = vx;
-            verts[vi][1] = vy;
-        }
+    // Paragraph quads hang from the top of the box (y <= 0)
+    const float top = paragraph_mode() ? old_h : 0.0f;
+    m_run_xform[0] = sx_anim;
+    m_run_xform[1] = sy_anim;
+    m_run_xform[2] = center_new_x + (old_x - center_old_x) * sx_anim;
+    m_run_xform[3] = center_new_y + (old_y + top - center_old_y) * sy_anim;
+    m_rect = DrawRect{x, y, box_w, box_h, true};
+    m_run.placed = true;
+}
 
-        glBindTexture(GL_TEXTURE_2D, g.texture_id);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(verts), verts);
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+void GuiText::update(float /*dt*/, GuiInputState& /*input*/)
+{
+    m_rect.valid = false;
+    if (!m_visible) return;
+    // Culling uses the box of the last layout (setters lay out at once, so it
+    // follows edits made off screen). Glyphs may overhang the box by their
+    // bearings, hence the margin.
+    if (m_run.font) {
+        place_run();
+        const float pad = 0.5f * m_rect.h;
+        if (culled(m_rect.x - pad, m_rect.y - pad, m_rect.w + 2.0f * pad, m_rect.h + 2.0f * pad)) {
+            m_rect.valid = false;
+            return;
+        }
+    }
+    if (!layout_run()) { m_rect.valid = false; return; }
+    place_run();
+    // Glyphs on screen this frame are not evictable
+    const unsigned long frame = GuiDraw::frame_index();
+    for (Glyph* g : m_run.glyphs) {
+        if (g) g->last_used = frame;
+    }
+    if (m_finalize_frame != frame) {
+        m_finalize_frame = frame;
+        s_frame_texts.push_back(this);
+    }
+}
 
-        pen_x += static_cast<float>(g.advance >> 6);
+void GuiText::finalize_frame()
+{
+    upload_ready_glyphs();
+    // A run laid out later in the update pass may have repacked an atlas
+    // (moved UVs) or been given a new text after its own update. Glyphs of
+    // the listed runs are all stamped this frame, so nothing they use is
+    // evicted and a second pass only inserts glyphs loaded by the first.
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (GuiText* text : s_frame_texts) {
+            if (!text->m_rect.valid || (text->run_current() && text->m_run.placed)) continue;
+            if (!text->layout_run()) { text->m_rect.valid = false; continue; }
+            text->place_run();
+            changed = true;
+        }
+    }
+    // Dirty atlas rows go to the GPU once, before any run is drawn
+    for (GuiText* text : s_frame_texts) {
+        if (text->m_rect.valid) text->m_run.texture = text->m_run.font->atlas->texture();
     }
+    s_frame_texts.clear();
+}
 
-    glBindVertexArray(0);
-    glUseProgram(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+void GuiText::draw() const
+{
+    // Finished by finalize_frame(): draw() reads the run, it does not lay it out
+    if (!m_visible || !m_rect.valid || m_finalize_frame != GuiDraw::frame_index()) return;
+    if (m_run.texture == 0) return;
 
-    if (depthWasEnabled) glEnable(GL_DEPTH_TEST);
+    float final_col[4];
+    apply_animation_to_color(m_color, final_col);
+    // One texture for the whole string: the run is a single batch
+    GuiDraw::draw_glyph_run(m_run.quads.data(), static_cast<int>(m_run.quads.size()), m_run.texture, final_col,
+                            m_run_xform, m_run.font->sdf);
 }
@@ -4,7 +4,15 @@
 #include <string>
 #include <unordered_map>
 #include <memory>
+#include <vector>
 #include "GuiElement.h"
+#include "GuiDraw.h"
+#include "GuiFontRegistry.h"
+#include "GuiKerning.h"
+#include "GuiTextMetrics.h"
+#include "GuiSdf.h"
+
+class GuiGlyphAtlas;
 
 // Public API: GuiText class for HUD/menus overlay rendering.
 // Coordinates are in screen pixels by default (origin at bottom-left),
@@ -17,17 +25,78 @@ public:
     // Core setters
     void set_position(float x, float y, bool in_percentage = false); // override position handling
     void set_text(const std::string& str);
-    bool set_text_font(const std::string& font_path); // returns true on success
+    // Add to the end of the text (chat logs): a paragraph reflows its last line only
+    void append_text(const std::string& str);
+    bool set_text_font(const std::string& font_path); // returns true on success (font mapped once per file)
     void set_text_size(int size_1_to_10);             // relative scale 1..10
+    static int pixel_size(int size_1_to_10);          // pixel size of a level (any font)
     void set_text_color(float r, float g, float b, float a);
+    // Signed-distance-field glyphs: one atlas per font serves every size level
+    // and animated scale stays sharp. Off => one coverage bitmap set per size.
+    void set_text_sdf(bool enabled);
+    bool text_sdf() const { return m_sdf; }
+    // Initial set_text_sdf() value of GuiText instances created afterwards
+    static void set_sdf_default(bool enabled) { s_sdf_default = enabled; }
+    // Glyphs are rasterized on demand (UTF-8 text). Each font atlas is capped to
+    // this many texels (bytes); when full, glyphs not drawn this frame are
+    // evicted least-recently-used first. Applies to fonts loaded afterwards.
+    static void set_glyph_cache_budget(std::size_t bytes_per_font) { s_glyph_budget = bytes_per_font; }
+    // Rasterize new glyphs on GuiGlyphRasterizer workers (default on). Their
+    // metrics are read right away, so layout is final; until the bitmap is
+    // uploaded the glyph is left blank. At most `bytes` of bitmaps are uploaded
+    // per frame. Off => rasterize on the calling (GL) thread.
+    static void set_async_glyphs(bool enabled) { s_async_glyphs = enabled; }
+    static void set_glyph_upload_budget(std::size_t bytes) { s_upload_budget = bytes; }
+    // Map a .mgef file written by mge_fontbake and install its atlases: texts
+    // using a baked (font path, size) start without FreeType; glyphs missing
+    // from the bake are still rasterized on demand. Call before drawing.
+    static bool load_baked_fonts(const std::string& path);
+    // Fallback chain of `font_path` (empty path: default chain of fonts that
+    // have none): a codepoint missing from the font comes from the first font
+    // of the chain that has it, rasterized into the same atlas, so mixed
+    // scripts still draw as one batch. The font each codepoint resolves to is
+    // cached. Set before drawing: glyphs already loaded are kept. Returns
+    // false if a fallback could not be opened (it is left out of the chain).
+    static bool set_font_fallbacks(const std::string& font_path, const std::vector<std::string>& fallback_paths);
+
+    // Paragraph layout: wrap words at `width_px` (0 = single line, the
+    // default); '\n' starts a new line. Line breaks are cached: set_text()
+    // and append_text() reflow from the line before the first changed byte
+    // and stop as soon as a break lands where it was before the edit.
+    // The box is wrap width x line count; each line is aligned within it.
+    enum class TextAlign { Left, Center, Right };
+    void set_wrap_width(float width_px);
+    void set_text_align(TextAlign align);
+    void set_line_spacing(float factor);   // line advance = factor * pixel size (default 1.2)
+    int line_count() const;                // lines of the laid-out paragraph (1 if single line)
+
+    // Numeric labels (HUD counters, percentages): set_number() formats
+    // `value` with `decimals` fraction digits (0..9) into a fixed buffer, no
+    // allocation, between the affixes. Digits share one advance (the widest)
+    // so the label does not jitter, and an update rewrites only the quads of
+    // the characters that changed. NaN and values beyond +-1e18 show "--".
+    // set_text() leaves number mode.
+    void set_number(double value, int decimals = 0);
+    void set_number_affixes(const std::string& prefix, const std::string& suffix); // e.g. "FPS ", "%"
 
     // Optional helpers
     void show();
     void hide();
     bool visible() const { return m_visible; }
 
-    // Draw the text. Requires a current OpenGL context.
-    void draw() override;
+    // Setters lay the run out at once (shaping, glyph loads), so the const
+    // queries below only read it. update() refreshes the run if the atlas
+    // changed under it, places it and marks its glyphs as used this frame;
+    // draw() only queues the finished run (no layout, no GL call).
+    // A text whose box (as of its last layout) is off screen or clipped out
+    // is culled: not placed, finalized or drawn.
+    void update(float dt, GuiInputState& input) override;
+    void draw() const override;
+    // Once per frame, after the update pass and before the draw pass: runs of
+    // the texts updated this frame are refreshed against the final atlases
+    // (UVs after the last repack, bitmaps uploaded since) and the dirty atlas
+    // rows are uploaded to their textures.
+    static void finalize_frame();
 
     // Preferred size (in pixels) based on current text and font/size
     std::pair<float,float> preferred_size() const override;
@@ -38,67 +107,229 @@ public:
     // Returns false if font/text not ready; outputs are zeroed.
     bool vertical_extents(float& ascent, float& descent) const;
 
-    // Allow dynamic update on framebuffer resize if needed in future.
-    static void on_framebuffer_resized(int fb_width, int fb_height);
+    // Measure any UTF-8 string in this text's font and size (width, ascent,
+    // descent in pixels) without replacing the cached run of the current text.
+    // Loads missing glyphs. Returns false if the font is not ready; outputs are zeroed.
+    bool measure_text(const std::string& str, float& width, float& ascent, float& descent) const;
+
+    // Fraction of the current font/size atlas covered by glyph pixels (0 if not loaded)
+    float atlas_fill_ratio() const;
 
 private:
     // Internals
-    bool ensure_font_loaded() const; // lazy-load selected font
-    static bool init_renderer();     // lazy GL/FT init for shared resources
+    bool ensure_font_loaded();       // glyph table and atlas of the selected font/size
+    void relayout();                 // setters: font, then run (nothing until a font is set)
+    static bool init_renderer();     // lazy FreeType init via GuiFontRegistry (drawing goes through GuiDraw)
     static void shutdown_renderer();
 
     float pixel_x_from_pos() const; // computes pixel x from pos/percent
     float pixel_y_from_pos() const; // computes pixel y from pos/percent
     int   pixel_size_for_level() const; // maps 1..10 to pixel size
-    float text_width_pixels() const;    // measured width based on glyph advances
+    float text_width_pixels() const;    // measured width based on kerned glyph advances
 
     // Data
     std::string m_text;
     std::string m_font_path;
-    mutable bool m_font_ready = false;
+    FontId m_font_id = kInvalidFontId; // GuiFontRegistry id of m_font_path
+    bool m_font_ready = false;
     int  m_size_level = 5; // 1..10
     float m_color[4] = {1.f, 1.f, 1.f, 1.f};
+    bool m_sdf = s_sdf_default;
+    float m_wrap_width = 0.0f;
+    TextAlign m_align = TextAlign::Left;
+    float m_line_spacing = 1.2f;
+    static bool s_sdf_default;
+    static std::size_t s_glyph_budget;
+    static bool s_async_glyphs;
+    static std::size_t s_upload_budget;
+    static unsigned long s_upload_frame; // frame of the last upload_ready_glyphs()
+
+    // SDF atlases are rasterized once at this size, with this spread (pixels)
+    static constexpr int kSdfBasePx = GuiSdf::kGlyphBasePx;
+    static constexpr int kSdfSpread = GuiSdf::kGlyphSpread;
 
     // Rendering backend (shared between all GuiText instances)
-    struct Glyph {
-        unsigned int texture_id = 0; // GL texture
-        int width = 0;
-        int height = 0;
-        int bearing_x = 0; // left bearing
-        int bearing_y = 0; // top bearing
-        unsigned int advance = 0; // advance.x in 1/64 pixels (FreeType)
-    };
+    using Glyph = GuiGlyph;
 
     struct FontKey {
-        std::string path;
-        int pixel_size;
+        FontId font;
+        int pixel_size;    // raster size (kSdfBasePx for SDF fonts)
+        bool sdf = false;
         bool operator==(const FontKey& o) const {
-            return pixel_size == o.pixel_size && path == o.path;
+            return font == o.font && pixel_size == o.pixel_size && sdf == o.sdf;
         }
     };
 
     struct FontKeyHash {
         std::size_t operator()(const FontKey& k) const noexcept {
-            std::hash<std::string> h;
-            return (h(k.path) ^ (static_cast<std::size_t>(k.pixel_size) * 1315423911u));
+            return (static_cast<std::size_t>(k.font) * 1315423911u) ^ (static_cast<std::size_t>(k.pixel_size) << 1) ^ (k.sdf ? 1u : 0u);
         }
     };
 
-    // Cache glyphs per (font_path, pixel_size)
-    using GlyphMap = std::unordered_map<unsigned long, Glyph>; // codepoint -> glyph
-    static std::unordered_map<FontKey, GlyphMap, FontKeyHash> s_glyph_cache;
+    // Shaped string: glyphs with kerned pen positions, in raster pixels (the
+    // caller multiplies by glyph_scale). Memoized per font and string, so
+    // kerning costs nothing once a string has been seen.
+    struct ShapedRun {
+        std::vector<unsigned long> codepoints; // glyphs found (malformed/missing skipped)
+        std::vector<float> pen_x;              // pen position of each glyph
+        float width = 0.0f;                    // advances plus kerning
+        float ascent = 0.0f;
+        float descent = 0.0f;
+        int pending = 0;                       // metrics of pending glyphs are predicted
+        int skipped = 0;                       // left out at the atlas budget (retried)
+        unsigned int glyph_epoch = 0;          // font glyph_epoch at shaping
+    };
+    static constexpr std::size_t kMaxShapedRuns = 1024; // memo is cleared beyond this
+
+    // Cache glyphs per (font, pixel_size), all packed into one atlas texture.
+    // Glyphs are loaded on first use through the registry's face and size.
+    using GlyphMap = GuiTextMetrics; // codepoint -> glyph (dense Latin + open addressing)
+    struct FontData {
+        FontId font_id = kInvalidFontId;
+        GlyphMap glyphs;
+        std::unique_ptr<GuiGlyphAtlas> atlas;
+        unsigned int uv_generation = 0; // atlas generation the glyph UVs were read at
+        bool sdf = false;
+        int raster_px = 0;              // pixel size the glyphs were rasterized at
+        bool warned_full = false;
+        unsigned int glyph_epoch = 0;   // bumped when pending glyphs are uploaded
+        unsigned int skipped = 0;       // glyphs left out at the budget since the last retry
+        const GuiKerning* kerning = nullptr; // pair table of the font file (null: none)
+        std::unordered_map<std::string, ShapedRun> shaped; // string -> shaped run
+    };
+    FontKey font_key() const;
+    FontData* font_data() const; // loaded font of font_key(), null if none
+    static std::unordered_map<FontKey, FontData, FontKeyHash> s_glyph_cache;
+    // Kerning pairs per font file, read once when its face is first opened
+    static std::unordered_map<FontId, GuiKerning> s_kerning;
+    static const GuiKerning* kerning_for(FontId font);
+    static float kerning_px(const FontData& font, unsigned int left, unsigned int right); // raster pixels
+    static const ShapedRun& shape(FontData& font, const std::string& str); // loads glyphs, memoized
+    // Fallback chains per primary font and the font each codepoint resolved
+    // to (probed once per codepoint, whatever the size)
+    struct FontFallback {
+        bool own_chain = false;   // false: s_default_fallbacks
+        std::vector<FontId> chain;
+        std::unordered_map<unsigned long, FontId> resolved;
+    };
+    static std::unordered_map<FontId, FontFallback> s_fallbacks;
+    static std::vector<FontId> s_default_fallbacks;
+    static FontId resolve_font(FontId primary, unsigned long codepoint); // primary if no font has it
+    static void refresh_glyph_uvs(FontData& font);
+    static Glyph* glyph_for(FontData& font, unsigned long codepoint); // loads on demand
+    // Same, counting in `skipped` a glyph left out because the atlas is full
+    static Glyph* glyph_for(FontData& font, unsigned long codepoint, int& skipped);
+    static bool predict_glyph(FontData& font, FontId source, unsigned long codepoint, Glyph& out);
+    static bool place_glyph(FontData& font, unsigned long codepoint, Glyph& glyph,
+                            const unsigned char* pixels, int pitch);
+    static void upload_ready_glyphs(); // once per frame, within s_upload_budget
+    float glyph_scale(const FontData& font) const;
+    static bool evict_glyphs(FontData& font);
 
-    // Shared GL objects
-    static unsigned int s_vao;
-    static unsigned int s_vbo;
-    static unsigned int s_shader;
-    static int s_uProjLoc;
-    static int s_uTextColorLoc;
+    // Laid-out run of m_text, rebuilt by the setters (or when the atlas was
+    // repacked, by update() and finalize_frame()). Quads are box-local: the
+    // bottom-left of the text box is (0,0); update() positions and animates
+    // the run with a GPU transform.
+    struct RunCache {
+        bool valid = false;
+        FontData* font = nullptr;
+        unsigned int atlas_generation = 0;
+        std::vector<GuiDraw::GlyphQuad> quads;
+        std::vector<Glyph*> glyphs;   // stamped on update for LRU (valid while generation matches)
+        int pending = 0;              // glyphs drawn blank until their bitmap is uploaded
+                                      // or left out at the atlas budget (retried)
+        unsigned int glyph_epoch = 0; // font glyph_epoch at layout
+        float width = 0.0f;    // sum of kerned advances (paragraph: wrap width)
+        float ascent = 0.0f;   // vertical_extents() of the text
+        float descent = 0.0f;
+        float height = 0.0f;   // box height (paragraph: every line)
+        GLuint texture = 0;    // atlas texture, uploaded by finalize_frame()
+        bool placed = false;   // m_rect and m_run_xform follow this layout
+    };
+    RunCache m_run;
+    bool layout_run();         // lays out or refreshes m_run
+    bool run_current() const;  // laid out against the current atlas and glyph uploads
+    unsigned long m_finalize_frame = ~0ul;  // frame listed in s_frame_texts
+    static std::vector<GuiText*> s_frame_texts; // updated this frame, finalized once
+    // Position and animate the run: GPU transform for draw() and the
+    // animated text box in m_rect
+    void place_run();
+    float m_run_xform[4] = {1.0f, 1.0f, 0.0f, 0.0f};
+    void invalidate_run() { m_run.valid = false; }
+    void invalidate_layout() // font/size change: full reflow
+    {
+        m_run.valid = false; m_para.valid = false; m_number.laid = false;
+        mark_layout_dirty();
+    }
 
-    // FreeType
-    static void* s_ft_library; // FT_Library (void* to avoid including ft headers in header file)
+    // Line breaks of a paragraph (m_wrap_width > 0). Glyph arrays are flat
+    // over all lines and parallel to m_run.glyphs; quads are top-anchored
+    // (y <= 0) so lines after an edit keep their quads (moved by whole line
+    // heights when the edit changed the line count).
+    struct ParaLine {
+        std::size_t begin = 0;        // byte range of the line's glyphs in m_text
+        std::size_t end = 0;
+        std::size_t next = 0;         // start of the next line (after the break)
+        std::size_t glyph_begin = 0;  // range in the glyph arrays
+        std::size_t glyph_end = 0;
+        std::size_t quad_end = 0;     // end of the line's quads in m_run.quads
+        float width = 0.0f;           // pixels, trailing break spaces excluded
+        int pending = 0;              // glyphs drawn blank until uploaded
+        int skipped = 0;              // left out at the atlas budget: the line is reflowed
+    };
+    struct ParagraphCache {
+        bool valid = false;
+        FontData* font = nullptr;
+        std::vector<ParaLine> lines;
+        std::vector<unsigned long> codepoints;
+        std::vector<float> pen_x;         // line-local pen position (pixels)
+        std::size_t laid_size = 0;        // m_text size at the last layout
+        std::size_t clean_prefix = 0;     // bytes unchanged since the last layout
+        std::size_t clean_suffix = 0;
+        bool quads_dirty = false;         // alignment or spacing changed
+        unsigned int atlas_generation = 0;
+        unsigned int glyph_epoch = 0;
+        std::size_t reflowed_lines = 0;   // lines measured by the last layout
+        // Scratch of reflow_paragraph: the reflowed lines before they replace
+        // the old ones (capacity kept across edits)
+        std::vector<ParaLine> new_lines;
+        std::vector<unsigned long> new_codepoints;
+        std::vector<float> new_pen_x;
+        std::vector<Glyph*> new_glyphs;
+        std::vector<GuiDraw::GlyphQuad> new_quads;
+    };
+    ParagraphCache m_para;
+    bool paragraph_mode() const { return m_wrap_width > 0.0f && !m_number.active; }
+    bool ensure_paragraph_run(FontData& font);
+    void reflow_paragraph(FontData& font); // lays out the changed lines and their quads
+    void lay_line(FontData& font, std::size_t pos, ParaLine& line); // into the new_* scratch
+    void lay_line_quads(const FontData& font, std::size_t index, std::vector<GuiDraw::GlyphQuad>& out);
+    void build_paragraph_quads(const FontData& font, std::size_t from_line);
 
-    // Framebuffer size for ortho projection
-    static int s_fb_width;
-    static int s_fb_height;
+    // Number mode (set_number): m_run.quads holds the prefix quads, then one
+    // slot per character of the number (zero-sized when blank), then the
+    // suffix quads. Characters come from a small fixed set whose glyphs are
+    // resolved once per layout.
+    static constexpr int kMaxNumberChars = 32;
+    static constexpr int kNumberGlyphs = 12; // "0123456789-."
+    struct NumberCache {
+        bool active = false;
+        bool laid = false;                    // prefix/suffix quads and glyphs are current
+        std::string prefix;
+        std::string suffix;
+        char text[kMaxNumberChars] = {};      // formatted value
+        int len = 0;
+        char laid_text[kMaxNumberChars] = {}; // value the slots show
+        int laid_len = 0;
+        float pen_x[kMaxNumberChars + 1] = {}; // pen position of each character, [len] = end
+        Glyph* glyphs[kNumberGlyphs] = {};
+        std::size_t prefix_quads = 0;
+        std::vector<GuiDraw::GlyphQuad> suffix_quads; // relative to the end of the number
+        float origin_x = 0.0f;                // start of the number (raster pixels)
+        float digit_advance = 0.0f;           // widest digit (raster pixels)
+        float suffix_width = 0.0f;
+    };
+    NumberCache m_number;
+    bool ensure_number_run(FontData& font);
+    void lay_number_chars(const FontData& font, int from); // slots from `from` on, then the suffix
 };
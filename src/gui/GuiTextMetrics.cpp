@@ -0,0 +1,214 @@
+// GuiTextMetrics.cpp - Implementation of the glyph table and text measurement
+
+#include "GuiTextMetrics.h"
+
+#include <algorithm>
+
+namespace {
+
+inline std::size_t hash_codepoint(std::uint32_t cp, std::size_t mask)
+{
+    return static_cast<std::size_t>(cp * 2654435761u) & mask; // Knuth multiplicative hash
+}
+
+// By value (std::max returns a reference, which compiles to a branch here)
+inline float max_f(float a, float b) { return a > b ? a : b; }
+
+} // namespace
+
+GuiTextMetrics::GuiTextMetrics(bool fractional_advance)
+    : m_fractional(fractional_advance)
+{
+    std::fill(m_dense, m_dense + kDenseCount, kNoSlot);
+}
+
+GuiTextMetrics::Metric GuiTextMetrics::metric_of(const GuiGlyph& g) const
+{
+    Metric m;
+    m.advance = m_fractional ? static_cast<float>(g.advance) / 64.0f : static_cast<float>(g.advance >> 6);
+    m.ascent = static_cast<float>(g.bearing_y - g.pad);
+    m.descent = static_cast<float>(g.height - g.bearing_y - g.pad);
+    return m;
+}
+
+GuiTextMetrics::Slot GuiTextMetrics::sparse_find(std::uint32_t cp) const
+{
+    if (m_keys.empty()) return kNoSlot;
+    const std::size_t mask = m_keys.size() - 1;
+    for (std::size_t i = hash_codepoint(cp, mask);; i = (i + 1) & mask) {
+        if (m_keys[i] == cp) return m_values[i];
+        if (m_keys[i] == kNoCodepoint) return kNoSlot;
+    }
+}
+
+void GuiTextMetrics::sparse_grow()
+{
+    std::vector<std::uint32_t> keys;
+    std::vector<Slot> values;
+    keys.swap(m_keys);
+    values.swap(m_values);
+    const std::size_t cap = keys.empty() ? 64 : keys.size() * 2;
+    m_keys.assign(cap, kNoCodepoint);
+    m_values.assign(cap, kNoSlot);
+    m_sparse_count = 0;
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        if (keys[i] != kNoCodepoint) sparse_insert(keys[i], values[i]);
+    }
+}
+
+void GuiTextMetrics::sparse_insert(std::uint32_t cp, Slot slot)
+{
+    if ((m_sparse_count + 1) * 4 > m_keys.size() * 3) sparse_grow();
+    const std::size_t mask = m_keys.size() - 1;
+    std::size_t i = hash_codepoint(cp, mask);
+    while (m_keys[i] != kNoCodepoint && m_keys[i] != cp) i = (i + 1) & mask;
+    if (m_keys[i] == kNoCodepoint) ++m_sparse_count;
+    m_keys[i] = cp;
+    m_values[i] = slot;
+}
+
+void GuiTextMetrics::sparse_erase(std::uint32_t cp)
+{
+    if (m_keys.empty()) return;
+    const std::size_t mask = m_keys.size() - 1;
+    std::size_t i = hash_codepoint(cp, mask);
+    while (m_keys[i] != cp) {
+        if (m_keys[i] == kNoCodepoint) return;
+        i = (i + 1) & mask;
+    }
+    // Backward-shift deletion: move later entries of the probe chain into the hole
+    std::size_t hole = i;
+    for (std::size_t j = (i + 1) & mask; m_keys[j] != kNoCodepoint; j = (j + 1) & mask) {
+        const std::size_t home = hash_codepoint(m_keys[j], mask);
+        // Entry j may fill the hole if its home is not in (hole, j] (cyclically)
+        const bool stays = (hole <= j) ? (hole < home && home <= j) : (hole < home || home <= j);
+        if (stays) continue;
+        m_keys[hole] = m_keys[j];
+        m_values[hole] = m_values[j];
+        hole = j;
+    }
+    m_keys[hole] = kNoCodepoint;
+    m_values[hole] = kNoSlot;
+    --m_sparse_count;
+}
+
+GuiTextMetrics::Slot GuiTextMetrics::find_slot(unsigned long codepoint) const
+{
+    if (codepoint < kDenseCount) return m_dense[codepoint];
+    if (codepoint >= kNoCodepoint) return kNoSlot;
+    return sparse_find(static_cast<std::uint32_t>(codepoint));
+}
+
+GuiGlyph* GuiTextMetrics::find(unsigned long codepoint)
+{
+    const Slot s = find_slot(codepoint);
+    return s == kNoSlot ? nullptr : &m_glyphs[s];
+}
+
+const GuiGlyph* GuiTextMetrics::find(unsigned long codepoint) const
+{
+    const Slot s = find_slot(codepoint);
+    return s == kNoSlot ? nullptr : &m_glyphs[s];
+}
+
+GuiGlyph* GuiTextMetrics::insert(unsigned long codepoint, const GuiGlyph& glyph)
+{
+    if (codepoint >= kNoCodepoint) return nullptr;
+    Slot s = find_slot(codepoint);
+    if (s == kNoSlot) {
+        if (!m_free.empty()) {
+            s = m_free.back();
+            m_free.pop_back();
+        } else {
+            s = static_cast<Slot>(m_glyphs.size());
+            m_glyphs.emplace_back();
+            m_metrics.emplace_back();
+            m_codepoints.push_back(kNoCodepoint);
+        }
+        m_codepoints[s] = static_cast<std::uint32_t>(codepoint);
+        if (codepoint < kDenseCount) m_dense[codepoint] = s;
+        else sparse_insert(static_cast<std::uint32_t>(codepoint), s);
+        ++m_count;
+    }
+    m_glyphs[s] = glyph;
+    m_metrics[s] = metric_of(glyph);
+    return &m_glyphs[s];
+}
+
+bool GuiTextMetrics::erase(unsigned long codepoint)
+{
+    const Slot s = find_slot(codepoint);
+    if (s == kNoSlot) return false;
+    if (codepoint < kDenseCount) m_dense[codepoint] = kNoSlot;
+    else sparse_erase(static_cast<std::uint32_t>(codepoint));
+    m_codepoints[s] = kNoCodepoint;
+    m_free.push_back(s);
+    --m_count;
+    return true;
+}
+
+GuiTextExtents GuiTextMetrics::measure(const std::string& utf8, float scale) const
+{
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(utf8.data());
+    const unsigned char* const end = p + utf8.size();
+    const Metric* metrics = m_metrics.data();
+
+    // Two independent accumulators so consecutive ASCII glyphs do not wait on
+    // each other's add/max (the loop is latency bound, not lookup bound)
+    float width0 = 0.0f, width1 = 0.0f;
+    float ascent = 0.0f, descent = 0.0f;
+    int missing = 0;
+
+    while (p < end) {
+        // ASCII pairs: no decoding, dense lookups only
+        while (end - p >= 2 && (p[0] | p[1]) < 0x80) {
+            const Slot s0 = m_dense[p[0]];
+            const Slot s1 = m_dense[p[1]];
+            p += 2;
+            if (s0 == kNoSlot || s1 == kNoSlot) {
+                // Rare: at least one glyph is not loaded yet
+                if (s0 == kNoSlot) ++missing;
+                else { const Metric m = metrics[s0]; width0 += m.advance; ascent = max_f(ascent, m.ascent); descent = max_f(descent, m.descent); }
+                if (s1 == kNoSlot) ++missing;
+                else { const Metric m = metrics[s1]; width1 += m.advance; ascent = max_f(ascent, m.ascent); descent = max_f(descent, m.descent); }
+                continue;
+            }
+            const Metric m0 = metrics[s0];
+            const Metric m1 = metrics[s1];
+            width0 += m0.advance;
+            width1 += m1.advance;
+            ascent = max_f(ascent, max_f(m0.ascent, m1.ascent));
+            descent = max_f(descent, max_f(m0.descent, m1.descent));
+        }
+        if (p >= end) break;
+
+        // One codepoint (ASCII tail or multi-byte sequence)
+        unsigned long cp = *p++;
+        if (cp >= 0x80) {
+            int extra = 0;
+            if ((cp & 0xE0) == 0xC0) { cp &= 0x1F; extra = 1; }
+            else if ((cp & 0xF0) == 0xE0) { cp &= 0x0F; extra = 2; }
+            else if ((cp & 0xF8) == 0xF0) { cp &= 0x07; extra = 3; }
+            else continue; // stray continuation or invalid lead byte
+            bool ok = true;
+            for (int k = 0; k < extra; ++k) {
+                if (p >= end || (*p & 0xC0) != 0x80) { ok = false; break; }
+                cp = (cp << 6) | (*p++ & 0x3F);
+            }
+            if (!ok) continue;
+        }
+        const Slot s = find_slot(cp);
+        if (s == kNoSlot) { ++missing; continue; }
+        const Metric m = metrics[s];
+        width0 += m.advance;
+        ascent = max_f(ascent, m.ascent);
+        descent = max_f(descent, m.descent);
+    }
+
+    GuiTextExtents out;
+    out.width = (width0 + width1) * scale;
+    out.ascent = ascent * scale;
+    out.descent = descent * scale;
+    out.missing = missing;
+    return out;
+}
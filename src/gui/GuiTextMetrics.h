@@ -0,0 +1,101 @@
+// GuiTextMetrics.h - Per-font glyph table and single-pass string measurement
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+// Glyph of a font atlas: FreeType metrics plus its rect in the atlas texture
+struct GuiGlyph {
+    float u0 = 0.f, v0 = 0.f;    // UV rect in the font atlas (top-left)
+    float u1 = 0.f, v1 = 0.f;    // (bottom-right)
+    int width = 0;
+    int height = 0;
+    int bearing_x = 0; // left bearing
+    int bearing_y = 0; // top bearing
+    unsigned int advance = 0; // advance.x in 1/64 pixels (FreeType)
+    int pad = 0;       // SDF spread around the ink (0 for coverage glyphs)
+    unsigned int glyph_index = 0; // FreeType glyph id (kerning pairs are keyed by it)
+    unsigned long last_used = 0; // GuiDraw::frame_index() of the last use (LRU)
+    bool pending = false; // metrics known, bitmap still being rasterized (not in the atlas)
+};
+
+// Extents of a string in pixels, relative to the baseline (ink only)
+struct GuiTextExtents {
+    float width = 0.0f;    // sum of advances
+    float ascent = 0.0f;   // max distance above the baseline
+    float descent = 0.0f;  // max distance below the baseline
+    int missing = 0;       // codepoints not in the table (not measured)
+};
+
+// Codepoint -> glyph table of one font/size.
+// - U+0000..U+024F (Basic Latin to Latin Extended-B) index a dense array;
+//   other codepoints live in a linear-probing open-addressed table.
+// - Glyphs are stored in a deque, so GuiGlyph* stay valid until erase().
+// - The advance/ascent/descent used for measurement are kept in a separate
+//   12-byte record per glyph: measure() decodes, looks up and accumulates a
+//   whole UTF-8 string in one pass without touching the larger GuiGlyph.
+class GuiTextMetrics {
+public:
+    static constexpr unsigned long kDenseCount = 0x250;
+
+    // fractional_advance: keep 26.6 advances exact (scaled SDF glyphs);
+    // otherwise they are truncated to whole pixels like the bitmap renderer
+    explicit GuiTextMetrics(bool fractional_advance = false);
+
+    GuiGlyph* find(unsigned long codepoint);
+    const GuiGlyph* find(unsigned long codepoint) const;
+    // Add (or replace) a glyph; returns its stored copy
+    GuiGlyph* insert(unsigned long codepoint, const GuiGlyph& glyph);
+    bool erase(unsigned long codepoint);
+    std::size_t size() const { return m_count; }
+
+    // Call f(codepoint, GuiGlyph&) for every glyph (do not insert/erase inside)
+    template <class F> void for_each(F&& f)
+    {
+        for (std::size_t s = 0; s < m_codepoints.size(); ++s) {
+            if (m_codepoints[s] != kNoCodepoint) f(static_cast<unsigned long>(m_codepoints[s]), m_glyphs[s]);
+        }
+    }
+
+    // Width and ink extents of a UTF-8 string, with glyph metrics multiplied
+    // by `scale`. Malformed bytes are skipped; codepoints without a glyph are
+    // counted in `missing` so the caller can load them and measure again.
+    GuiTextExtents measure(const std::string& utf8, float scale = 1.0f) const;
+
+private:
+    using Slot = std::uint32_t;
+    static constexpr Slot kNoSlot = 0xFFFFFFFFu;
+    static constexpr std::uint32_t kNoCodepoint = 0xFFFFFFFFu;
+
+    struct Metric {
+        float advance;  // pixels (unscaled)
+        float ascent;   // bearing_y - pad
+        float descent;  // height - bearing_y - pad
+    };
+
+    Slot find_slot(unsigned long codepoint) const;
+    Slot sparse_find(std::uint32_t codepoint) const;
+    void sparse_insert(std::uint32_t codepoint, Slot slot);
+    void sparse_erase(std::uint32_t codepoint);
+    void sparse_grow();
+    Metric metric_of(const GuiGlyph& g) const;
+
+    bool m_fractional = false;
+    std::size_t m_count = 0;
+
+    // Slot storage (index = Slot); freed slots are reused
+    std::deque<GuiGlyph> m_glyphs;
+    std::vector<Metric> m_metrics;
+    std::vector<std::uint32_t> m_codepoints;   // kNoCodepoint for free slots
+    std::vector<Slot> m_free;
+
+    Slot m_dense[kDenseCount];
+
+    // Open addressing (power-of-two capacity, load <= 3/4, backward-shift erase)
+    std::vector<std::uint32_t> m_keys;         // kNoCodepoint = empty bucket
+    std::vector<Slot> m_values;
+    std::size_t m_sparse_count = 0;
+};
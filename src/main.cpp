@@ -16,7 +16,11 @@
 #include "gui/GuiCheckbox.h"
 #include "gui/GuiProgressBar.h"
 #include "gui/GuiMenuBar.h"
+#include "gui/GuiLogView.h"
 #include "gui/GuiManager.h"
+#include "gui/GuiDraw.h"
+#include "gui/GuiFrameContext.h"
+#include "gui/GuiFrameUniforms.h"
 #include "gui/AnimationManager.h"
 
 #include <cstdio>
@@ -31,6 +35,9 @@
 #ifndef SHADER_DIR
 #  define SHADER_DIR "./shaders"
 #endif
+#ifndef FONT_BAKE_FILE
+#  define FONT_BAKE_FILE "./fonts.mgef"
+#endif
 
 // État global minimal de la fenêtre
 static bool g_frameless = false;
@@ -48,6 +55,7 @@ void toggle_fullscreen(GLFWwindow* window);
 void cursor_pos_callback(GLFWwindow* window, double xpos, double ypos);
 void mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
 void char_callback(GLFWwindow* window, unsigned int codepoint);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 
 std::string load_text_file(const std::string& path);
 GLuint compile_shader(GLenum type, const std::string& src);
@@ -126,6 +134,7 @@ int main()
     glfwSetCursorPosCallback(window, cursor_pos_callback);
     glfwSetMouseButtonCallback(window, mouse_button_callback);
     glfwSetCharCallback(window, char_callback);
+    glfwSetScrollCallback(window, scroll_callback);
 
     // 5) Géométrie simple (triangle)
     const float vertices[] = {
@@ -165,8 +174,8 @@ int main()
         return EXIT_FAILURE;
     }
 
-    // Récupération de l'uniforme de projection
-    GLint uProjLoc = glGetUniformLocation(prog, "uProjection");
+    // La projection vient du bloc uniforme FrameData (GuiFrameUniforms), partagé avec la GUI
+    GuiFrameUniforms::bind_program(prog);
 
     glEnable(GL_DEPTH_TEST);
 
@@ -203,6 +212,11 @@ int main()
         return std::string();
     };
 
+    // Glyphes SDF : un seul atlas par police pour toutes les tailles et animations
+    GuiText::set_sdf_default(true);
+    // Atlas précalculés par mge_fontbake (avant tout set_text_font) : pas d'init FreeType au démarrage
+    GuiText::load_baked_fonts(FONT_BAKE_FILE);
+
     GuiText hud;
     hud.set_text("MGE-XLR");
     hud.set_text_size(4);
@@ -219,6 +233,16 @@ int main()
     }
     hud.set_text_font("resources/Jersey25-Regular.ttf");
 
+    // Console en jeu (F1) : les callbacks de démo y écrivent au lieu de stdout.
+    // append()/appendf() sont utilisables depuis n'importe quel thread.
+    GuiLogView console;
+    console.set_text_font("resources/Jersey25-Regular.ttf");
+    console.set_text_size(2);
+    console.set_size(560.0f, 180.0f, false);
+    console.set_alignment(GuiElement::GuiAlignment::BottomLeft);
+    console.set_anchor_offset(12.0f, 40.0f, false);
+    console.hide();
+
     // Crée un panneau pour contenir les textes (HUD container)
     // Demo GUI Panel containing all new widgets
     GuiPanel panel;
@@ -231,15 +255,16 @@ int main()
     panel.setLayout(GuiPanel::LayoutType::VERTICAL);
     panel.setPadding(6.0f);
     panel.setSpacing(8.0f);
+    panel.setClipChildren(true); // the dropdown of the menubar still escapes
 
     // MenuBar inside panel
     GuiMenuBar menubar;
     menubar.set_text_font("resources/Jersey25-Regular.ttf");
     menubar.set_text_size(3);
     menubar.add_menu("Fichier");
-    menubar.add_menu_item("Fichier", "Nouveau", [](){ std::puts("Menu: Fichier > Nouveau"); });
-    menubar.add_menu_item("Fichier", "Ouvrir", [](){ std::puts("Menu: Fichier > Ouvrir"); });
-    menubar.add_menu_item("Fichier", "Quitter", [](){ std::puts("Menu: Fichier > Quitter"); });
+    menubar.add_menu_item("Fichier", "Nouveau", [&](){ console.append("Menu: Fichier > Nouveau"); });
+    menubar.add_menu_item("Fichier", "Ouvrir", [&](){ console.append("Menu: Fichier > Ouvrir"); });
+    menubar.add_menu_item("Fichier", "Quitter", [&](){ console.append("Menu: Fichier > Quitter"); });
     panel.addChild(&menubar);
 
     // Title text
@@ -250,7 +275,7 @@ int main()
     input.set_text_font("resources/Jersey25-Regular.ttf");
     input.set_text_size(3);
     input.set_placeholder("Tapez votre nom...");
-    input.set_on_text_change([](const std::string& s){ std::printf("[Input] text=""%s""\n", s.c_str()); });
+    input.set_on_text_change([&](const std::string& s){ console.appendf("[Input] text=\"%s\"", s.c_str()); });
     panel.addChild(&input);
 
     // Image
@@ -261,9 +286,10 @@ int main()
 
     // Slider controlling value shown in text
     GuiText value_text; value_text.set_text_font("resources/Jersey25-Regular.ttf"); value_text.set_text_size(3); value_text.set_text_color(0.9f,0.9f,0.95f,1.0f);
-    value_text.set_text("Slider: 0.0");
+    value_text.set_number_affixes("Slider: ", "");
+    value_text.set_number(0.0, 1);
     GuiSlider slider; slider.set_range(0.0f, 100.0f); slider.set_value(0.0f);
-    slider.set_on_value_changed([&](float v){ char buf[64]; std::snprintf(buf, sizeof(buf), "Slider: %.1f", v); value_text.set_text(buf); std::printf("[Slider] value=%.3f\n", v); });
+    slider.set_on_value_changed([&](float v){ value_text.set_number(v, 1); console.appendf("[Slider] value=%.3f", v); });
     panel.addChild(&value_text);
     // Demonstrate moveBy on a text element (slide right a bit)
     value_text.moveBy(24.0f, 0.0f, 0.8f);
@@ -273,7 +299,7 @@ int main()
     GuiCheckbox checkbox; checkbox.set_text_font("resources/Jersey25-Regular.ttf"); checkbox.set_text_size(3); checkbox.set_label("Activer logs");
     bool logs_enabled = true;
     checkbox.set_checked(logs_enabled);
-    checkbox.set_on_toggle([&](bool checked){ logs_enabled = checked; std::printf("[Checkbox] logs %s\n", checked?"ON":"OFF"); });
+    checkbox.set_on_toggle([&](bool checked){ logs_enabled = checked; console.appendf("[Checkbox] logs %s", checked?"ON":"OFF"); });
     panel.addChild(&checkbox);
 
     // Progress bar updated dynamically
@@ -311,7 +337,7 @@ int main()
     GuiButton btnPlay; btnPlay.set_text_font("resources/Jersey25-Regular.ttf"); btnPlay.set_text_size(4);
     btnPlay.set_alignment(GuiElement::GuiAlignment::Center);
     btnPlay.set_text("Play"); btnPlay.set_corner_radius(6.0f);
-    btnPlay.set_on_click([](){ std::puts("[Main Menu] Play clicked"); });
+    btnPlay.set_on_click([&](){ console.append("[Main Menu] Play clicked"); });
     mainMenu.addChild(&btnPlay);
 
     GuiButton btnOptions; btnOptions.set_text_font("resources/Jersey25-Regular.ttf"); btnOptions.set_text_size(4);
@@ -401,7 +427,7 @@ int main()
     btnQuit.slideIn(GuiElement::SlideDir::Down, 0.7f);
     // Pulse on hover and shake on click for feedback
     btnPlay.set_on_hover([&btnPlay](){ btnPlay.pulse(1.06f, 0.25f); });
-    btnPlay.set_on_click([&](){ std::puts("[Main Menu] Play clicked"); btnPlay.shake(8.0f, 0.4f, 28.0f); });
+    btnPlay.set_on_click([&](){ console.append("[Main Menu] Play clicked"); btnPlay.shake(8.0f, 0.4f, 28.0f); });
     // Options page title color transition
     titleOptions.colorTo(0.9f, 0.9f, 1.0f, 1.0f, 0.8f);
 
@@ -418,23 +444,30 @@ int main()
         float aspect = (fbh > 0) ? (static_cast<float>(fbw) / static_cast<float>(fbh)) : 1.0f;
         auto proj = make_perspective(60.0f, aspect, 0.1f, 100.0f);
 
+        // Contexte de la frame (viewport, ortho, perspective, échelle, temps) : construit
+        // une seule fois ici, aucun glGet* côté GUI ensuite. Le bloc uniforme FrameData
+        // est envoyé une fois pour la scène et la GUI.
+        double now = glfwGetTime();
+        float dt = static_cast<float>(now - last_time);
+        if (dt < 0.0f) dt = 0.0f; if (dt > 0.1f) dt = 0.1f; // clamp
+        last_time = now;
+        float content_sx = 1.0f, content_sy = 1.0f;
+        glfwGetWindowContentScale(window, &content_sx, &content_sy);
+        const GuiFrameContext gui_ctx = GuiFrameContext::make(fbw, fbh, content_sx, content_sy, now, dt, true, proj.data());
+        // Seul point d'écriture du contexte courant de la frame (lu par les
+        // widgets via GuiFrameContext::current())
+        GuiFrameContext::set_current(gui_ctx);
+        GuiFrameUniforms::update(gui_ctx);
+
         glClearColor(0.08f, 0.08f, 0.10f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         glUseProgram(prog);
-        if (uProjLoc >= 0) {
-            glUniformMatrix4fv(uProjLoc, 1, GL_FALSE, proj.data());
-        }
-
         glBindVertexArray(vao);
         glDrawArrays(GL_TRIANGLES, 0, 3);
 
         // Update animations
-        double now = glfwGetTime();
-        float dt = static_cast<float>(now - last_time);
-        if (dt < 0.0f) dt = 0.0f; if (dt > 0.1f) dt = 0.1f; // clamp
-        AnimationManager::instance().update(dt);
-        last_time = now;
+        AnimationManager::instance().update(gui_ctx);
 
         // Update progress for demo
         {
@@ -443,13 +476,30 @@ int main()
             progress.set_progress(p);
         }
 
-        // Dessin du panneau (désactivé via panel.hide()) puis de la page active
+        // Entrées de la frame (instantané), puis deux passes sur l'arbre GUI :
+        // update() traite entrées, état et mise en page ; draw() (const) ne fait
+        // qu'enregistrer la géométrie dans la draw list GuiDraw, soumise en une
+        // fois par GuiDraw::flush() (voir GuiDraw::frame_stats()).
+        GuiInputState input = GuiInput::snapshot();
+        if (input.key_pressed(GLFW_KEY_F1)) {
+            if (console.visible()) console.hide(); else console.show();
+        }
+        GuiDraw::begin_frame(gui_ctx);
+        panel.update(dt, input);        // panneau désactivé via panel.hide()
+        guiManager.update(dt, input);   // page active uniquement
+        footer.update(dt, input);       // textes alignés sur la fenêtre
+        corner.update(dt, input);
+        console.update(dt, input);
+        // Textes terminés avant le dessin : UV après le dernier repack de
+        // l'atlas, lignes modifiées envoyées au GPU (draw() ne touche pas à GL)
+        GuiText::finalize_frame();
+
         panel.draw();
         guiManager.draw();
-
-        // Draw free-floating aligned texts (relative to window)
-    footer.draw();
-    corner.draw();
+        footer.draw();
+        corner.draw();
+        console.draw();
+        GuiDraw::flush();
 
         glfwSwapBuffers(window);
     }
@@ -458,6 +508,7 @@ int main()
     glDeleteBuffers(1, &vbo);
     glDeleteVertexArrays(1, &vao);
     glDeleteProgram(prog);
+    GuiFrameUniforms::shutdown();
 
     glfwDestroyWindow(window);
     glfwTerminate();
@@ -492,8 +543,7 @@ void framebuffer_size_callback(GLFWwindow* /*window*/, int width, int height)
 {
     // Important : utiliser la taille du framebuffer (pixels), pas celle de la fenêtre (points)
     glViewport(0, 0, width, height);
-    // Notifier le module texte pour recalculer la projection orthographique
-    GuiText::on_framebuffer_resized(width, height);
+    // La GUI relit la taille du framebuffer chaque frame via GuiFrameContext
 }
 
 void cursor_pos_callback(GLFWwindow* window, double xpos, double ypos)
@@ -516,6 +566,11 @@ void char_callback(GLFWwindow* window, unsigned int codepoint)
     GuiInput::glfw_char_callback(window, codepoint);
 }
 
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+    GuiInput::glfw_scroll_callback(window, xoffset, yoffset);
+}
+
 void key_callback(GLFWwindow* window, int key, int /*scancode*/, int action, int /*mods*/)
 {
     // Forward to GUI input system (records both PRESS and RELEASE)
@@ -0,0 +1,280 @@
+// mge_fontbake.cpp - Offline font atlas baker (writes .mgef files for GuiText::load_baked_fonts)
+//
+// Usage: mge_fontbake -o <out.mgef> [-c <ranges>] <font>:<sizes> [<font>:<sizes> ...]
+//   <sizes>  comma-separated pixel sizes and/or "sdf", e.g. resources/Jersey25-Regular.ttf:18,24,sdf
+//   -c       codepoints to bake, e.g. 0x20-0x7E,0xE9 (default: Latin-1 and common French punctuation)
+// Font paths are stored as given: pass them exactly as the game passes them to set_text_font().
+
+#include "GuiFontBake.h"
+#include "GuiAtlasPacker.h"
+#include "GuiKerning.h"
+#include "GuiSdf.h"
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* kDefaultChars = "0x20-0x7E,0xA0-0xFF,0x152-0x153,0x178,0x2013-0x2014,0x2018-0x2019,0x201C-0x201D,0x2026,0x20AC";
+
+struct BakeJob {
+    std::string path;
+    int pixel_size = 0;
+    bool sdf = false;
+};
+
+struct BakedFont {
+    BakeJob job;
+    int atlas_w = 0;
+    int atlas_h = 0;
+    std::vector<GuiFontBake::GlyphRecord> glyphs;
+    std::vector<GuiFontBake::ShelfRecord> shelves;
+    std::vector<unsigned char> pixels;
+    GuiKerning kerning;
+};
+
+static bool parse_ranges(const std::string& spec, std::vector<unsigned long>& out)
+{
+    std::size_t pos = 0;
+    while (pos < spec.size()) {
+        std::size_t end = spec.find(',', pos);
+        if (end == std::string::npos) end = spec.size();
+        const std::string item = spec.substr(pos, end - pos);
+        const std::size_t dash = item.find('-');
+        char* tail = nullptr;
+        const unsigned long first = std::strtoul(item.c_str(), &tail, 0);
+        unsigned long last = first;
+        if (dash != std::string::npos) last = std::strtoul(item.c_str() + dash + 1, &tail, 0);
+        if (item.empty() || last < first || last > 0x10FFFF) return false;
+        for (unsigned long cp = first; cp <= last; ++cp) out.push_back(cp);
+        pos = end + 1;
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return !out.empty();
+}
+
+static bool parse_font_arg(const std::string& arg, std::vector<BakeJob>& jobs)
+{
+    const std::size_t colon = arg.rfind(':');
+    if (colon == std::string::npos || colon == 0 || colon + 1 == arg.size()) return false;
+    const std::string path = arg.substr(0, colon);
+    std::size_t pos = colon + 1;
+    while (pos <= arg.size()) {
+        std::size_t end = arg.find(',', pos);
+        if (end == std::string::npos) end = arg.size();
+        const std::string item = arg.substr(pos, end - pos);
+        BakeJob job;
+        job.path = path;
+        if (item == "sdf") {
+            job.sdf = true;
+            job.pixel_size = GuiSdf::kGlyphBasePx;
+        } else {
+            job.pixel_size = std::atoi(item.c_str());
+            if (job.pixel_size <= 0 || job.pixel_size > 512) return false;
+        }
+        jobs.push_back(job);
+        pos = end + 1;
+    }
+    return true;
+}
+
+static bool bake(FT_Library lib, const BakeJob& job, const std::vector<unsigned long>& chars, BakedFont& out)
+{
+    FT_Face face = nullptr;
+    if (FT_New_Face(lib, job.path.c_str(), 0, &face) != 0) {
+        std::fprintf(stderr, "[mge_fontbake] Failed to load font face: %s\n", job.path.c_str());
+        return false;
+    }
+    FT_Set_Pixel_Sizes(face, 0, static_cast<FT_UInt>(job.pixel_size));
+
+    // Same packer and SDF conversion as the runtime, so baked and on-demand
+    // glyphs are identical
+    GuiAtlasPacker atlas(256, 4096);
+    std::vector<GuiFontBake::GlyphRecord> glyphs;
+    std::vector<unsigned char> sdf_pixels;
+    bool ok = true;
+    for (unsigned long cp : chars) {
+        const FT_UInt glyph_index = FT_Get_Char_Index(face, static_cast<FT_ULong>(cp));
+        if (glyph_index == 0) continue; // not in the font
+        if (FT_Load_Char(face, static_cast<FT_ULong>(cp), FT_LOAD_RENDER) != 0) continue;
+        FT_GlyphSlot g = face->glyph;
+        int w = static_cast<int>(g->bitmap.width);
+        int h = static_cast<int>(g->bitmap.rows);
+        int bearing_x = g->bitmap_left;
+        int bearing_y = g->bitmap_top;
+        int pad = 0;
+        const unsigned char* pixels = g->bitmap.buffer;
+        int pitch = g->bitmap.pitch;
+        if (job.sdf && w > 0 && h > 0) {
+            GuiSdf::from_coverage(g->bitmap.buffer, w, h, pitch, GuiSdf::kGlyphSpread, sdf_pixels, w, h);
+            pixels = sdf_pixels.data();
+            pitch = w;
+            pad = GuiSdf::kGlyphSpread;
+            bearing_x -= pad;
+            bearing_y += pad;
+        }
+        if (!atlas.add(cp, pixels, w, h, pitch)) {
+            std::fprintf(stderr, "[mge_fontbake] Atlas full (%dx%d) for %s:%d\n", atlas.width(), atlas.height(),
+                         job.path.c_str(), job.pixel_size);
+            ok = false;
+            break;
+        }
+        GuiFontBake::GlyphRecord rec{};
+        rec.codepoint = static_cast<std::uint32_t>(cp);
+        rec.bearing_x = static_cast<std::int16_t>(bearing_x);
+        rec.bearing_y = static_cast<std::int16_t>(bearing_y);
+        rec.advance = static_cast<std::uint32_t>(g->advance.x);
+        rec.pad = static_cast<std::int16_t>(pad);
+        rec.glyph_index = static_cast<std::uint16_t>(glyph_index);
+        glyphs.push_back(rec);
+    }
+    out.kerning.load(face); // empty if the font has no kerning
+    FT_Done_Face(face);
+    if (!ok) return false;
+
+    // Tallest-first repack for the final layout, then read the rects back
+    atlas.compact();
+    for (GuiFontBake::GlyphRecord& rec : glyphs) {
+        GuiAtlasPacker::Rect r;
+        atlas.find(rec.codepoint, r);
+        rec.x = static_cast<std::uint16_t>(r.x);
+        rec.y = static_cast<std::uint16_t>(r.y);
+        rec.w = static_cast<std::uint16_t>(r.w);
+        rec.h = static_cast<std::uint16_t>(r.h);
+    }
+    out.job = job;
+    out.atlas_w = atlas.width();
+    out.atlas_h = atlas.height();
+    out.glyphs = std::move(glyphs);
+    for (const GuiAtlasPacker::Shelf& s : atlas.shelves()) {
+        out.shelves.push_back(GuiFontBake::ShelfRecord{s.y, s.height, s.cursor_x});
+    }
+    out.pixels.assign(atlas.pixels(), atlas.pixels() + static_cast<std::size_t>(out.atlas_w) * out.atlas_h);
+    std::printf("[mge_fontbake] %s:%s%d -> %zu glyphs, %dx%d atlas (%.0f%% used), %zu kerning pairs\n",
+                job.path.c_str(), job.sdf ? "sdf@" : "", job.pixel_size, out.glyphs.size(), out.atlas_w, out.atlas_h,
+                100.0 * atlas.fill_ratio(), out.kerning.size());
+    return true;
+}
+
+static void append(std::vector<unsigned char>& blob, const void* data, std::size_t bytes)
+{
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    blob.insert(blob.end(), p, p + bytes);
+}
+
+static void align8(std::vector<unsigned char>& blob)
+{
+    blob.resize((blob.size() + 7u) & ~static_cast<std::size_t>(7u), 0);
+}
+
+static bool write_file(const std::string& path, const std::vector<BakedFont>& fonts)
+{
+    using namespace GuiFontBake;
+    std::vector<unsigned char> blob;
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.font_count = static_cast<std::uint32_t>(fonts.size());
+    append(blob, &header, sizeof(header));
+    blob.resize(blob.size() + fonts.size() * sizeof(FontHeader)); // filled below
+
+    for (std::size_t i = 0; i < fonts.size(); ++i) {
+        const BakedFont& f = fonts[i];
+        // Kerning is per font file: stored with its first size only
+        bool first_of_file = true;
+        for (std::size_t k = 0; k < i; ++k) first_of_file = first_of_file && fonts[k].job.path != f.job.path;
+        FontHeader fh{};
+        fh.pixel_size = f.job.pixel_size;
+        fh.flags = (f.job.sdf ? kFlagSdf : 0u) | (first_of_file ? kFlagKerning : 0u);
+        fh.atlas_width = f.atlas_w;
+        fh.atlas_height = f.atlas_h;
+        align8(blob);
+        fh.path_offset = static_cast<std::uint32_t>(blob.size());
+        fh.path_length = static_cast<std::uint32_t>(f.job.path.size());
+        append(blob, f.job.path.data(), f.job.path.size());
+        align8(blob);
+        fh.glyph_count = static_cast<std::uint32_t>(f.glyphs.size());
+        fh.glyphs_offset = static_cast<std::uint32_t>(blob.size());
+        append(blob, f.glyphs.data(), f.glyphs.size() * sizeof(GlyphRecord));
+        align8(blob);
+        fh.shelf_count = static_cast<std::uint32_t>(f.shelves.size());
+        fh.shelves_offset = static_cast<std::uint32_t>(blob.size());
+        append(blob, f.shelves.data(), f.shelves.size() * sizeof(ShelfRecord));
+        align8(blob);
+        if (first_of_file) {
+            fh.units_per_em = f.kerning.units_per_em();
+            fh.kern_offset = static_cast<std::uint32_t>(blob.size());
+            for (const GuiKerning::Pair& p : f.kerning.pairs()) {
+                const KernRecord kr{p.left, p.right, p.value, 0};
+                append(blob, &kr, sizeof(kr));
+                ++fh.kern_count;
+            }
+            align8(blob);
+        }
+        fh.pixels_offset = static_cast<std::uint32_t>(blob.size());
+        append(blob, f.pixels.data(), f.pixels.size());
+        std::memcpy(&blob[sizeof(FileHeader) + i * sizeof(FontHeader)], &fh, sizeof(fh));
+    }
+
+    FILE* out = std::fopen(path.c_str(), "wb");
+    if (!out) {
+        std::fprintf(stderr, "[mge_fontbake] Cannot write %s\n", path.c_str());
+        return false;
+    }
+    const bool ok = std::fwrite(blob.data(), 1, blob.size(), out) == blob.size();
+    std::fclose(out);
+    if (!ok) std::fprintf(stderr, "[mge_fontbake] Write failed: %s\n", path.c_str());
+    return ok;
+}
+
+static void usage()
+{
+    std::fprintf(stderr, "usage: mge_fontbake -o <out.mgef> [-c <ranges>] <font>:<sizes> [...]\n"
+                         "  <sizes>: comma-separated pixel sizes and/or 'sdf' (e.g. font.ttf:18,24,sdf)\n"
+                         "  -c: codepoint ranges (default %s)\n", kDefaultChars);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::string out_path;
+    std::string chars_spec = kDefaultChars;
+    std::vector<BakeJob> jobs;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc) out_path = argv[++i];
+        else if (arg == "-c" && i + 1 < argc) chars_spec = argv[++i];
+        else if (!parse_font_arg(arg, jobs)) {
+            std::fprintf(stderr, "[mge_fontbake] Bad argument: %s\n", arg.c_str());
+            usage();
+            return 2;
+        }
+    }
+    std::vector<unsigned long> chars;
+    if (out_path.empty() || jobs.empty() || !parse_ranges(chars_spec, chars)) {
+        usage();
+        return 2;
+    }
+
+    FT_Library lib = nullptr;
+    if (FT_Init_FreeType(&lib) != 0) {
+        std::fprintf(stderr, "[mge_fontbake] FreeType init failed.\n");
+        return 1;
+    }
+    std::vector<BakedFont> fonts(jobs.size());
+    bool ok = true;
+    for (std::size_t i = 0; i < jobs.size() && ok; ++i) ok = bake(lib, jobs[i], chars, fonts[i]);
+    FT_Done_FreeType(lib);
+    if (!ok || !write_file(out_path, fonts)) return 1;
+    return 0;
+}